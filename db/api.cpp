@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+#include <fmt/format.h>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "api.hpp"
+
+namespace Db::Api {
+    namespace {
+        auto makeCursor(Connection& connection, Query const& query) -> Cursor {
+            auto& database = connection.database;
+            database.pool.statement = database.pool.tick;
+            auto const result = connection.parser.executeQuery(query);
+
+            auto cursor = Cursor();
+            if (!result.partitions.empty()) {
+                // rows of several partitions are copied into columns of their own, in the order of the result
+                auto const columns = connection.parser.materialize(result);
+                cursor.rows = Utils::getRows(Table{result.table, columns});
+                for (auto const& column : columns) {
+                    cursor.names.push_back(column.name);
+                    cursor.types.push_back(column.type);
+                    cursor.columns.push_back(column.data);
+                }
+                return cursor;
+            }
+
+            auto& table = *Utils::getTable(database, result.table);
+            cursor.rows = result.rows;
+            for (auto const& name : result.columns) {
+                auto const& column = database.fetch(table, name);
+                // numbers are parsed in the table, so the cursor and later queries share them
+                if (column.type == ColumnType::NUMBER) {
+                    column.data.numbers();
+                }
+                cursor.names.push_back(name);
+                cursor.types.push_back(column.type);
+                cursor.columns.push_back(column.data);
+            }
+            return cursor;
+        }
+    }
+
+    auto Cursor::next(std::size_t size) -> std::optional<Batch> {
+        if (size == 0) {
+            throw std::invalid_argument("Batch size has to be greater than zero.");
+        }
+        if (position >= rows.size()) {
+            return std::nullopt;
+        }
+
+        auto const count = std::min(size, rows.size() - position);
+        auto batch = Batch{count};
+        for (auto i = std::size_t(0); i < columns.size(); ++i) {
+            auto const& values = std::as_const(columns[i]);
+            if (types[i] == ColumnType::NUMBER) {
+                auto const& numbers = values.numbers();
+                auto column = std::vector<double>(count);
+                for (auto k = std::size_t(0); k < count; ++k) {
+                    column[k] = numbers[rows[position + k]];
+                }
+                batch.columns.emplace_back(std::move(column));
+            } else {
+                auto column = std::vector<std::string_view>(count);
+                for (auto k = std::size_t(0); k < count; ++k) {
+                    column[k] = values[rows[position + k]];
+                }
+                batch.columns.emplace_back(std::move(column));
+            }
+        }
+        position += count;
+        return batch;
+    }
+    auto Cursor::remaining() const -> std::size_t {
+        return rows.size() - std::min(position, rows.size());
+    }
+
+    auto Statement::bind(std::size_t index, double value) -> Statement& {
+        return bind(index, fmt::format("{}", value));
+    }
+    auto Statement::bind(std::size_t index, std::string const& value) -> Statement& {
+        if (index >= parameters.size()) {
+            throw std::invalid_argument(fmt::format("Parameter '{}' does not exist, query has '{}' parameters.", index, parameters.size()));
+        }
+        bound[index] = value;
+        return *this;
+    }
+    auto Statement::execute() -> Cursor {
+        auto bound = query;
+        for (auto i = std::size_t(0); i < parameters.size(); ++i) {
+            if (!this->bound[i]) {
+                throw std::invalid_argument(fmt::format("Parameter '{}' is not bound.", i));
+            }
+            bound.where->values[parameters[i]] = *this->bound[i];
+        }
+        return makeCursor(connection, bound);
+    }
+
+    auto Connection::open(std::string const& path, std::size_t capacity) -> void {
+        database.waitForSnapshot();
+        if (std::filesystem::is_directory(path)) {
+            database.openFromDirectory(path, capacity);
+        } else {
+            database.openFromFile(path, capacity);
+        }
+    }
+    auto Connection::close() -> void {
+        database.waitForSnapshot();
+        // spilled pages of the closed database are removed, they are useless without it
+        database.resetPool();
+        database = Database();
+    }
+    auto Connection::execute(std::string const& command) -> void {
+        parser.parseQuery(command);
+    }
+    auto Connection::append(std::string const& tableName, std::vector<ColumnSpan> const& columns) -> void {
+        if (!Utils::tableExists(database, tableName)) {
+            throw std::invalid_argument(fmt::format("Table '{}' does not exist in database.", tableName));
+        }
+        auto& table = *Utils::getTable(database, tableName);
+        if (table.view) {
+            throw std::invalid_argument(fmt::format("Table '{}' is a materialized view and cannot be altered.", tableName));
+        }
+        if (Utils::isPartition(database, tableName)) {
+            throw std::invalid_argument(fmt::format("Table '{}' is a partition and can only be altered through its table.", tableName));
+        }
+        if (columns.size() != table.columns.size()) {
+            throw std::invalid_argument(fmt::format("Batch has '{}' columns but table has '{}' columns.", columns.size(), table.columns.size()));
+        }
+
+        // values are stored as text, numbers are formatted once here instead of by the caller
+        auto values = std::vector<std::vector<std::string>>(table.columns.size());
+        auto filled = std::vector<bool>(table.columns.size());
+        auto rows = std::optional<std::size_t>();
+        for (auto const& span : columns) {
+            if (!Utils::columnExists(table, span.name)) {
+                throw std::invalid_argument(fmt::format("Column '{}' does not exist in table '{}'.", span.name, tableName));
+            }
+            auto const index = static_cast<std::size_t>(Utils::getColumn(table, span.name) - table.columns.begin());
+            if (filled[index]) {
+                throw std::invalid_argument(fmt::format("Column '{}' is given more than once.", span.name));
+            }
+            filled[index] = true;
+
+            auto const& column = table.columns[index];
+            std::visit([&](auto const& data) -> void {
+                using Span = std::decay_t<decltype(data)>;
+                if (rows && *rows != data.size()) {
+                    throw std::invalid_argument(fmt::format("Column '{}' has '{}' values but other columns have '{}'.", span.name, data.size(), *rows));
+                }
+                rows = data.size();
+
+                values[index].reserve(data.size());
+                if constexpr (std::is_same_v<Span, std::span<double const>>) {
+                    if (column.type != ColumnType::NUMBER) {
+                        throw std::invalid_argument(fmt::format("Column '{}' is not a number column.", span.name));
+                    }
+                    // NaN is an empty value, like in the batches returned by cursors
+                    for (auto value : data) {
+                        values[index].push_back(std::isnan(value) ? std::string() : fmt::format("{}", value));
+                    }
+                } else {
+                    if (column.type != ColumnType::TEXT) {
+                        throw std::invalid_argument(fmt::format("Column '{}' is not a text column.", span.name));
+                    }
+                    for (auto const& value : data) {
+                        if (value.find('\n') != std::string::npos) {
+                            throw std::invalid_argument(fmt::format("Value in column '{}' cannot contain a line break.", span.name));
+                        }
+                        values[index].push_back(value);
+                    }
+                }
+            }, span.values);
+        }
+
+        // rows are routed by the number in their key, a NaN key has no partition and would reach the parser as text
+        if (table.partitioning) {
+            auto const& key = *Utils::getColumn(table, table.partitioning->column);
+            auto const& keys = values[static_cast<std::size_t>(&key - table.columns.data())];
+            if (key.type == ColumnType::NUMBER && std::ranges::any_of(keys, [](std::string const& value) { return value.empty(); })) {
+                throw std::runtime_error(fmt::format("Partition key column '{}' of table '{}' cannot hold NaN.", key.name, tableName));
+            }
+        }
+
+        database.pool.statement = database.pool.tick;
+        database.insertRows(tableName, values);
+        database.evict();
+    }
+    auto Connection::prepare(std::string const& query) -> Statement {
+        auto stream = std::stringstream(query);
+        auto command = std::string();
+        stream >> command;
+        std::ranges::transform(command.begin(), command.end(), command.begin(), toupper);
+        if (command != "SELECT") {
+            throw std::invalid_argument("Only SELECT queries can be prepared.");
+        }
+
+        auto statement = Statement{*this, parser.readSelectQuery(stream)};
+        if (statement.query.where) {
+            auto const& values = statement.query.where->values;
+            for (auto i = std::size_t(0); i < values.size(); ++i) {
+                if (values[i] == "?") {
+                    statement.parameters.push_back(i);
+                }
+            }
+        }
+        statement.bound.resize(statement.parameters.size());
+        return statement;
+    }
+    auto Connection::query(std::string const& query) -> Cursor {
+        return prepare(query).execute();
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "db.hpp"
+
+namespace Db::Api {
+    // values of one column for Connection::append, NUMBER columns take doubles and TEXT columns take strings
+    struct ColumnSpan {
+        std::string name;
+        std::variant<std::span<double const>, std::span<std::string const>> values;
+    };
+
+    // NUMBER columns come as doubles (NaN for empty values), TEXT columns as views into the data held by the cursor
+    using ColumnBatch = std::variant<std::vector<double>, std::vector<std::string_view>>;
+
+    struct Batch {
+        std::size_t rows = 0;
+        std::vector<ColumnBatch> columns = {};
+    };
+
+    // result of a query pulled a batch at a time, columns are copy-on-write snapshots so writes to the table made
+    // after the query do not change the rows returned or invalidate the views of earlier batches
+    struct Cursor {
+        std::vector<std::string> names = {};
+        std::vector<ColumnType> types = {};
+        std::vector<Values> columns = {};
+        std::vector<int> rows = {};
+        std::size_t position = 0;
+
+        auto next(std::size_t size = Filter::BATCH_SIZE) -> std::optional<Batch>;
+        auto remaining() const -> std::size_t;
+    };
+
+    struct Connection;
+
+    // SELECT parsed once and executed many times, every '?' value in WHERE is a parameter bound by position
+    struct Statement {
+        Connection& connection;
+        Query query;
+        std::vector<std::size_t> parameters = {};
+        std::vector<std::optional<std::string>> bound = {};
+
+        auto bind(std::size_t index, double value) -> Statement&;
+        auto bind(std::size_t index, std::string const& value) -> Statement&;
+        auto execute() -> Cursor;
+    };
+
+    struct Connection {
+        Database database;
+        Parser parser = {database};
+
+        Connection() = default;
+        Connection(Connection const& other) = delete;
+        Connection& operator=(Connection const& other) = delete;
+
+        auto open(std::string const& path, std::size_t capacity = 0) -> void;
+        auto close() -> void;
+        auto execute(std::string const& command) -> void;
+        auto append(std::string const& tableName, std::vector<ColumnSpan> const& columns) -> void;
+        auto prepare(std::string const& query) -> Statement;
+        auto query(std::string const& query) -> Cursor;
+    };
+}
@@ -0,0 +1,56 @@
+#include <bit>
+#include <cmath>
+#include <limits>
+
+#include "bloom.hpp"
+
+namespace Db::Bloom {
+    namespace {
+        // finalizer of MurmurHash3, spreads every input bit over both halves used for double hashing
+        auto mix(std::uint64_t hash) -> std::uint64_t {
+            hash ^= hash >> 33;
+            hash *= 0xFF51AFD7ED558CCDull;
+            hash ^= hash >> 33;
+            hash *= 0xC4CEB9FE1A85EC53ull;
+            hash ^= hash >> 33;
+            return hash;
+        }
+
+        auto position(std::uint64_t hash, int i) -> std::size_t {
+            auto const first = static_cast<std::uint32_t>(hash);
+            auto const second = static_cast<std::uint32_t>(hash >> 32) | 1;
+            return (first + static_cast<std::size_t>(i) * second) % CHUNK_BITS;
+        }
+    }
+
+    auto hashNumber(double value) -> std::uint64_t {
+        if (std::isnan(value)) {
+            value = std::numeric_limits<double>::quiet_NaN();
+        }
+        return mix(std::bit_cast<std::uint64_t>(value == 0.0 ? 0.0 : value));
+    }
+    auto hashText(std::string const& value) -> std::uint64_t {
+        auto hash = std::uint64_t(14695981039346656037ull);
+        for (auto character : value) {
+            hash ^= static_cast<unsigned char>(character);
+            hash *= 1099511628211ull;
+        }
+        return mix(hash);
+    }
+
+    auto insert(std::uint64_t* chunk, std::uint64_t hash) -> void {
+        for (auto i = 0; i < HASHES; ++i) {
+            auto const bit = position(hash, i);
+            chunk[bit / 64] |= std::uint64_t(1) << (bit % 64);
+        }
+    }
+    auto mayContain(std::uint64_t const* chunk, std::uint64_t hash) -> bool {
+        for (auto i = 0; i < HASHES; ++i) {
+            auto const bit = position(hash, i);
+            if ((chunk[bit / 64] >> (bit % 64) & 1) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
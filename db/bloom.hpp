@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "filter.hpp"
+
+namespace Db::Bloom {
+    // one filter per batch of rows, 8 bits per row of a full batch keep false positives near 2%
+    constexpr auto CHUNK_ROWS = Filter::BATCH_SIZE;
+    constexpr auto CHUNK_BITS = CHUNK_ROWS * 8;
+    constexpr auto CHUNK_WORDS = CHUNK_BITS / 64;
+    constexpr auto HASHES = 5;
+
+    // hashes do not depend on the build, so saved filters stay valid; numbers are hashed by value, so 1 and 1.0 match
+    auto hashNumber(double value) -> std::uint64_t;
+    auto hashText(std::string const& value) -> std::uint64_t;
+
+    auto insert(std::uint64_t* chunk, std::uint64_t hash) -> void;
+    // false means no value of the chunk has the hash, true may be a false positive
+    auto mayContain(std::uint64_t const* chunk, std::uint64_t hash) -> bool;
+}
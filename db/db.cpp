@@ -1,16 +1,35 @@
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
 #include <fmt/ranges.h>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <numeric>
 #include <ranges>
 #include <set>
 #include <string>
 #include <sstream>
+#include <utility>
 #include <vector>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #include "db.hpp"
+#include "bloom.hpp"
+#include "filter.hpp"
+#include "sort.hpp"
 
 namespace Db {
     namespace Utils {
@@ -52,15 +71,47 @@ namespace Db {
                 ) != column.data.end();
         };
         auto getNumberOfTables(Database const& database) -> int {
-            return database.tables.size();
+            return std::ranges::count_if(database.tables, [&database](Table const& table) { return !isPartition(database, table.name); });
         };
         auto getNumberOfColumns(Table const& table) -> int {
             return table.columns.size();
         };
+        auto getNumberOfRows(Table const& table) -> std::size_t {
+            if(table.columns.empty()) {
+                return 0;
+            }
+            return getNumberOfValues(table.columns[0]);
+        };
+        auto getRows(Table const& table, std::size_t firstRow) -> std::vector<int> {
+            auto firstIndex = static_cast<int>(firstRow);
+            auto rows = std::vector<int>(getNumberOfRows(table) - firstRow);
+            std::ranges::generate(rows.begin(), rows.end(), [&firstIndex]() -> int { return firstIndex++; });
+            return rows;
+        };
+        auto getNumberOfValues(Column const& column) -> std::size_t {
+            return column.resident ? column.data.size() : column.page->rows;
+        };
+        auto estimateColumnBytes(Column const& column) -> std::size_t {
+            if(!column.resident || column.data.empty()) {
+                return 0;
+            }
+            // sampling the first values is enough for the pool, exact sizes would cost a full column pass
+            auto const sample = std::min<std::size_t>(column.data.size(), 64);
+            auto heapBytes = std::size_t(0);
+            for(auto i = std::size_t(0); i < sample; ++i) {
+                if(column.data[i].capacity() > 15) {
+                    heapBytes += column.data[i].capacity() + 1;
+                }
+            }
+            return column.data.capacity() * sizeof(std::string) + heapBytes * column.data.size() / sample +
+                column.data.parsedSize() * sizeof(double) + (column.bloom ? column.bloom->capacity() * sizeof(std::uint64_t) : 0);
+        };
         auto getNamesOfTables(Database const& database) -> std::string {
             auto names = std::string();
             for(auto const& table: database.tables) {
-                names += table.name + " ";
+                if(!isPartition(database, table.name)) {
+                    names += table.name + " ";
+                }
             }
             return names.substr(0, names.size() - 1);
         };
@@ -97,7 +148,7 @@ namespace Db {
                 fmt::println("");
 
                 for(const auto& columnName : columns) {
-                    auto& column = *Utils::getColumn(table, columnName);
+                    auto const& column = *Utils::getColumn(table, columnName);
                     fmt::print("|{:<15}", column.data[index]);
                 }
                 fmt::print("|\n");
@@ -112,137 +163,1145 @@ namespace Db {
             fmt::print("+");
             fmt::println("");
         };
-        auto evaluateCondition(Table& table, const std::string& columnName, const std::string& condition, const std::string& conditionValue, int row) -> bool {
-            auto column = *getColumn(table, columnName);
-            auto value = column.data[row];
+        auto isNumber(const std::string& str) -> bool {
+            try {
+                std::stod(str);
+                return true;
+            } catch (...) {
+                return false;
+            }
+        }
+        auto validateColumnType(const Column& column, const std::string& value) -> void {
+            if (column.type == ColumnType::NUMBER && !isNumber(value)) {
+                throw std::invalid_argument("Value '" + value + "' is not a valid number for column '" + column.name + "'");
+            }
+        }
+        auto writeValues(std::fstream& file, Column const& column) -> void {
+            if (column.resident) {
+                for (auto const& value : column.data) {
+                    file << value << '\n';
+                }
+                return;
+            }
 
-            if(column.type == ColumnType::NUMBER) {
-                auto numConditionValue = std::stod(conditionValue);
-                auto numValue = std::stod(value);
+            auto page = std::fstream(column.page->path, std::ios::in);
+            if (!page) {
+                throw std::runtime_error(fmt::format("Cannot open page '{}' of column '{}'.", column.page->path, column.name));
+            }
+            page.seekg(column.page->offset);
+            auto value = std::string();
+            for (auto k = std::size_t(0); k < column.page->rows && std::getline(page, value); ++k) {
+                file << value << '\n';
+            }
+        }
+        auto getRemainingQuery(std::stringstream& stream) -> std::string {
+            auto const position = stream.tellg();
+            if (position < 0) {
+                return "";
+            }
+            return stream.str().substr(static_cast<std::size_t>(position));
+        }
+        auto normalizeQuery(std::string const& query) -> std::string {
+            // only whitespace is normalized, keywords and values are case sensitive for the parser
+            auto stream = std::stringstream(query);
+            auto normalized = std::string();
+            auto token = std::string();
+            while (stream >> token) {
+                normalized += token + " ";
+            }
+            return normalized.substr(0, normalized.size() - 1);
+        }
+        auto updateStatistics(Column& column, std::string const& value) -> void {
+            // statistics follow inserts approximately, ANALYZE makes them exact again
+            if (!column.statistics) {
+                return;
+            }
+            auto& statistics = *column.statistics;
+            auto const unique = statistics.distinct == statistics.rows - statistics.nulls;
+            ++statistics.rows;
+            if (value.empty()) {
+                ++statistics.nulls;
+                return;
+            }
+            if (unique) {
+                ++statistics.distinct;
+            }
+            auto const above = statistics.bounds.empty() || (column.type == ColumnType::NUMBER
+                ? std::stod(value) > std::stod(statistics.bounds.back())
+                : value > statistics.bounds.back());
+            if (above) {
+                if (statistics.bounds.empty()) {
+                    statistics.bounds.push_back(value);
+                } else {
+                    statistics.bounds.back() = value;
+                }
+            }
+        }
+        auto getPrefixEnd(std::string prefix) -> std::optional<std::string> {
+            // the smallest string above every string starting with prefix, none when the prefix is all 0xFF
+            while (!prefix.empty() && static_cast<unsigned char>(prefix.back()) == 0xFF) {
+                prefix.pop_back();
+            }
+            if (prefix.empty()) {
+                return std::nullopt;
+            }
+            prefix.back() = static_cast<char>(static_cast<unsigned char>(prefix.back()) + 1);
+            return prefix;
+        }
+        auto estimateSelectivity(Column const& column, Filter::Operator op, std::string const& value) -> double {
+            auto selectivity = 0.0;
+            if (!column.statistics || column.statistics->rows == 0) {
+                // textbook defaults when the column was never analyzed
+                selectivity = op == Filter::Operator::EQUAL ? 0.1 : op == Filter::Operator::NOT_EQUAL ? 0.9 : 1.0 / 3.0;
+            } else {
+                auto const& statistics = *column.statistics;
+                auto const present = 1.0 - static_cast<double>(statistics.nulls) / static_cast<double>(statistics.rows);
+                auto const equal = statistics.distinct == 0 ? 0.0 : present / static_cast<double>(statistics.distinct);
+
+                // share of the histogram buckets whose upper bound lies below the value
+                auto getBelow = [&column, &statistics](std::string const& value) -> double {
+                    auto below = 0.0;
+                    for (auto const& bound : statistics.bounds) {
+                        auto const less = column.type == ColumnType::NUMBER ? std::stod(bound) < std::stod(value) : bound < value;
+                        if (less) {
+                            below += 1.0;
+                        }
+                    }
+                    return statistics.bounds.empty() ? below : below / static_cast<double>(statistics.bounds.size());
+                };
+                auto const below = op == Filter::Operator::LIKE ? 0.0 : getBelow(value);
+
+                switch (op) {
+                    case Filter::Operator::EQUAL:
+                        selectivity = equal;
+                        break;
+                    case Filter::Operator::NOT_EQUAL:
+                        selectivity = present - equal;
+                        break;
+                    case Filter::Operator::LESS:
+                    case Filter::Operator::LESS_EQUAL:
+                        selectivity = present * below;
+                        break;
+                    case Filter::Operator::GREATER:
+                    case Filter::Operator::GREATER_EQUAL:
+                        selectivity = present * (1.0 - below);
+                        break;
+                    case Filter::Operator::LIKE: {
+                        // values matching a pattern lie between its literal prefix and the first value past the prefix
+                        auto const prefix = Filter::getPatternPrefix(value);
+                        auto const end = getPrefixEnd(prefix);
+                        selectivity = prefix.empty() ? present / 3.0 : present * std::max(equal, (end ? getBelow(*end) : 1.0) - getBelow(prefix));
+                        break;
+                    }
+                }
+            }
+            return std::clamp(selectivity, 0.001, 0.999);
+        }
+        auto syncFile(std::string const& path) -> void {
+#ifndef _WIN32
+            auto const descriptor = ::open(path.c_str(), O_RDONLY);
+            if (descriptor < 0) {
+                throw std::runtime_error(fmt::format("Cannot open '{}' for syncing.", path));
+            }
+            auto const result = ::fsync(descriptor);
+            ::close(descriptor);
+            if (result != 0) {
+                throw std::runtime_error(fmt::format("Cannot sync '{}' to disk.", path));
+            }
+#endif
+        }
+        auto filterRows(Table& table, Condition const& condition, std::vector<int>& rows) -> void {
+            auto columns = condition.columns;
+            auto conditions = condition.conditions;
+            auto values = condition.values;
+            auto const& operas = condition.operas;
+
+            // clauses joined by the same operator can be reordered, the first run includes the first clause and every
+            // later run follows the accumulated result; the cheapest clause per row it decides goes first
+            auto order = std::vector<std::size_t>(columns.size());
+            std::iota(order.begin(), order.end(), std::size_t(0));
+            auto rank = std::vector<double>(columns.size());
+            for(auto i = std::size_t(0); i < columns.size(); ++i) {
+                auto const& column = *Utils::getColumn(table, columns[i]);
+                auto const selectivity = Utils::estimateSelectivity(column, Filter::toOperator(conditions[i]), values[i]);
+                auto const cost = column.type == ColumnType::NUMBER ? 1.0 : 4.0;
+                auto const opera = i == 0 ? (operas.empty() ? "AND" : operas[0]) : operas[i - 1];
+                rank[i] = cost / (opera == "AND" ? 1.0 - selectivity : selectivity);
+            }
+            for(auto first = std::size_t(0); first < columns.size();) {
+                auto last = first + 1;
+                auto const opera = first == 0 ? (operas.empty() ? "AND" : operas[0]) : operas[first - 1];
+                while(last < columns.size() && operas[last - 1] == opera) {
+                    ++last;
+                }
+                std::ranges::stable_sort(order.begin() + first, order.begin() + last,
+                    [&rank](std::size_t a, std::size_t b) { return rank[a] < rank[b]; });
+                first = last;
+            }
 
-                if(condition == ">") {
-                    return numValue > numConditionValue;
+            auto reorder = [&order](std::vector<std::string>& clauses) -> void {
+                auto reordered = std::vector<std::string>();
+                for(auto index : order) {
+                    reordered.push_back(clauses[index]);
                 }
-                if(condition == ">=") {
-                    return numValue >= numConditionValue;
+                clauses = reordered;
+            };
+            reorder(columns);
+            reorder(conditions);
+            reorder(values);
+
+            // clauses are evaluated a batch at a time into bitmasks, rows are only materialized for the final mask
+            auto const total = Utils::getNumberOfRows(table);
+            auto candidates = std::vector<std::uint64_t>((total + 63) / 64);
+            for(auto row : rows) {
+                candidates[row / 64] |= std::uint64_t(1) << (row % 64);
+            }
+
+            auto operators = std::vector<Filter::Operator>();
+            auto numbers = std::vector<double>();
+            for(auto i = 0; i < columns.size(); ++i) {
+                auto const& column = *Utils::getColumn(table, columns[i]);
+                operators.push_back(Filter::toOperator(conditions[i]));
+                numbers.push_back(column.type == ColumnType::NUMBER ? std::stod(values[i]) : 0.0);
+            }
+
+            // == cannot hold for any row of a chunk whose Bloom filter lacks the value
+            auto blooms = std::vector<std::vector<std::uint64_t> const*>(columns.size());
+            auto hashes = std::vector<std::uint64_t>(columns.size());
+            for(auto i = 0; i < columns.size(); ++i) {
+                auto const& column = *Utils::getColumn(table, columns[i]);
+                if(operators[i] == Filter::Operator::EQUAL && column.bloom) {
+                    blooms[i] = column.bloom.get();
+                    hashes[i] = column.type == ColumnType::NUMBER ? Bloom::hashNumber(numbers[i]) : Bloom::hashText(values[i]);
                 }
-                if(condition == "<") {
-                    return numValue < numConditionValue;
+            }
+            auto excluded = [&](std::size_t clause, std::size_t first) -> bool {
+                auto const chunk = first / Bloom::CHUNK_ROWS;
+                return blooms[clause] && (chunk + 1) * Bloom::CHUNK_WORDS <= blooms[clause]->size() &&
+                    !Bloom::mayContain(blooms[clause]->data() + chunk * Bloom::CHUNK_WORDS, hashes[clause]);
+            };
+            auto const conjunctive = std::ranges::find(operas, "OR") == operas.end();
+
+            auto evaluate = [&](std::size_t clause, std::size_t first, std::size_t count, std::uint64_t* mask, std::uint64_t const* active) -> void {
+                if(excluded(clause, first)) {
+                    std::fill_n(mask, (count + 63) / 64, std::uint64_t(0));
+                    return;
                 }
-                if(condition == "<=") {
-                    return numValue <= numConditionValue;
+                auto const& column = *Utils::getColumn(table, columns[clause]);
+                if(column.type == ColumnType::NUMBER) {
+                    Filter::compareNumbers(operators[clause], column.data.numbers().data() + first, count, numbers[clause], mask);
+                } else {
+                    Filter::compareTexts(operators[clause], column.data.data() + first, count, values[clause], mask, active);
                 }
-                if(condition == "==") {
-                    return numValue == numConditionValue;
+            };
+
+            auto newRows = std::vector<int>();
+            auto include = std::array<std::uint64_t, Filter::BATCH_WORDS>();
+            auto next = std::array<std::uint64_t, Filter::BATCH_WORDS>();
+            auto active = std::array<std::uint64_t, Filter::BATCH_WORDS>();
+            for(auto first = std::size_t(0); first < total; first += Filter::BATCH_SIZE) {
+                auto const count = std::min(Filter::BATCH_SIZE, total - first);
+                auto const words = (count + 63) / 64;
+                auto const last = count % 64 == 0 ? ~std::uint64_t(0) : (std::uint64_t(1) << (count % 64)) - 1;
+
+                if(std::all_of(candidates.begin() + first / 64, candidates.begin() + first / 64 + words, [](std::uint64_t word) { return word == 0; })) {
+                    continue;
                 }
-                if(condition == "!=") {
-                    return numValue != numConditionValue;
+                // with AND only, one clause ruled out by its Bloom filter skips the whole chunk
+                auto skipped = false;
+                for(auto clause = std::size_t(0); conjunctive && !skipped && clause < columns.size(); ++clause) {
+                    skipped = excluded(clause, first);
                 }
-            } else {
-                if(condition == "==") {
-                    return value == conditionValue;
+                if(skipped) {
+                    continue;
+                }
+
+                evaluate(0, first, count, include.data(), nullptr);
+                for(auto i = 0; i < operas.size(); ++i) {
+                    // once AND has no row left or OR has every row, the next clause cannot change the outcome
+                    auto decided = true;
+                    for(auto word = std::size_t(0); word < words; ++word) {
+                        auto const valid = word + 1 == words ? last : ~std::uint64_t(0);
+                        active[word] = (operas[i] == "AND" ? include[word] : ~include[word]) & valid;
+                        decided = decided && active[word] == 0;
+                    }
+                    if(decided) {
+                        continue;
+                    }
+
+                    evaluate(i + 1, first, count, next.data(), active.data());
+                    if(operas[i] == "AND") {
+                        for(auto word = std::size_t(0); word < words; ++word) {
+                            include[word] &= next[word];
+                        }
+                    } else {
+                        for(auto word = std::size_t(0); word < words; ++word) {
+                            include[word] |= next[word];
+                        }
+                    }
+                }
+
+                for(auto word = std::size_t(0); word < words; ++word) {
+                    auto bits = include[word] & candidates[first / 64 + word];
+                    while(bits != 0) {
+                        newRows.push_back(static_cast<int>(first + word * 64 + std::countr_zero(bits)));
+                        bits &= bits - 1;
+                    }
                 }
-                if(condition == "!=") {
-                    return value != conditionValue;
+            }
+            rows = newRows;
+        }
+        auto parallelFor(std::size_t count, std::function<void(std::size_t)> const& work) -> void {
+            auto const threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+            if (count <= 1 || threads == 1) {
+                for (auto i = std::size_t(0); i < count; ++i) {
+                    work(i);
                 }
-                if(condition == ">") {
-                    return value > conditionValue;
+                return;
+            }
+
+            for (auto wave = std::size_t(0); wave < count; wave += threads) {
+                auto const last = std::min(count, wave + threads);
+                auto errors = std::vector<std::exception_ptr>(last - wave);
+                auto workers = std::vector<std::thread>();
+                for (auto i = wave; i < last; ++i) {
+                    workers.emplace_back([&work, &errors, wave, i]() -> void {
+                        try {
+                            work(i);
+                        } catch (...) {
+                            errors[i - wave] = std::current_exception();
+                        }
+                    });
                 }
-                if(condition == ">=") {
-                    return value >= conditionValue;
+                for (auto& worker : workers) {
+                    worker.join();
                 }
-                if(condition == "<") {
-                    return value < conditionValue;
+                for (auto const& error : errors) {
+                    if (error) {
+                        std::rethrow_exception(error);
+                    }
                 }
-                if(condition == "<=") {
-                    return value <= conditionValue;
+            }
+        }
+        auto lessThan(ColumnType type, std::string const& a, std::string const& b) -> bool {
+            return type == ColumnType::NUMBER ? std::stod(a) < std::stod(b) : a < b;
+        }
+        auto hashValue(ColumnType type, std::string const& value) -> std::uint64_t {
+            // FNV-1a, unlike std::hash it is the same in every build, so saved partitions stay valid; numbers are
+            // hashed in their shortest form, so 1 and 1.0 land in the same partition
+            auto const text = type == ColumnType::NUMBER ? fmt::format("{}", std::stod(value)) : value;
+            auto hash = std::uint64_t(14695981039346656037ull);
+            for (auto character : text) {
+                hash ^= static_cast<unsigned char>(character);
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+        auto getPartitionTable(Table const& table, Partition const& partition) -> std::string {
+            return table.name + "#" + partition.name;
+        }
+        auto isPartition(Database const& database, std::string const& name) -> bool {
+            return std::ranges::any_of(database.tables, [&name](Table const& table) {
+                return table.partitioning && std::ranges::any_of(table.partitioning->partitions,
+                    [&name, &table](Partition const& partition) { return getPartitionTable(table, partition) == name; });
+            });
+        }
+        auto findPartition(Table const& table, std::string const& value) -> std::optional<std::size_t> {
+            auto const& partitioning = *table.partitioning;
+            auto const type = std::ranges::find(table.columns, partitioning.column, &Column::name)->type;
+            if (partitioning.kind == Partitioning::Kind::HASH) {
+                return hashValue(type, value) % partitioning.partitions.size();
+            }
+            for (auto i = std::size_t(0); i < partitioning.partitions.size(); ++i) {
+                auto const& partition = partitioning.partitions[i];
+                if ((!partition.lower || !lessThan(type, value, *partition.lower)) && (!partition.upper || lessThan(type, value, *partition.upper))) {
+                    return i;
                 }
             }
+            return std::nullopt;
+        }
+        auto prunePartitions(Table const& table, std::optional<Condition> const& condition) -> std::vector<std::size_t> {
+            auto const& partitioning = *table.partitioning;
+            auto kept = std::vector<std::size_t>(partitioning.partitions.size());
+            std::iota(kept.begin(), kept.end(), std::size_t(0));
+            // a clause on the key only restricts the rows when every clause has to hold
+            if (!condition || std::ranges::find(condition->operas, "OR") != condition->operas.end()) {
+                return kept;
+            }
 
-            return false;
-        };
-        auto isNumber(const std::string& str) -> bool {
-            try {
-                std::stod(str);
-                return true;
-            } catch (...) {
-                return false;
+            auto const type = std::ranges::find(table.columns, partitioning.column, &Column::name)->type;
+            for (auto i = std::size_t(0); i < condition->columns.size(); ++i) {
+                if (condition->columns[i] != partitioning.column) {
+                    continue;
+                }
+                auto const op = Filter::toOperator(condition->conditions[i]);
+                auto const& value = condition->values[i];
+                std::erase_if(kept, [&](std::size_t index) -> bool {
+                    auto const& partition = partitioning.partitions[index];
+                    if (partitioning.kind == Partitioning::Kind::HASH) {
+                        return op == Filter::Operator::EQUAL && hashValue(type, value) % partitioning.partitions.size() != index;
+                    }
+                    auto const belowUpper = !partition.upper || lessThan(type, value, *partition.upper);
+                    auto const aboveLower = !partition.lower || !lessThan(type, value, *partition.lower);
+                    switch (op) {
+                        case Filter::Operator::GREATER:
+                        case Filter::Operator::GREATER_EQUAL:
+                            return !belowUpper;
+                        case Filter::Operator::LESS:
+                            return partition.lower && !lessThan(type, *partition.lower, value);
+                        case Filter::Operator::LESS_EQUAL:
+                            return partition.lower && lessThan(type, value, *partition.lower);
+                        case Filter::Operator::EQUAL:
+                            return !belowUpper || !aboveLower;
+                        case Filter::Operator::NOT_EQUAL:
+                            return false;
+                        case Filter::Operator::LIKE: {
+                            // matches lie in [prefix, end of prefix), like a >= and < pair
+                            auto const prefix = Filter::getPatternPrefix(value);
+                            auto const end = getPrefixEnd(prefix);
+                            auto const belowPrefix = partition.upper && !lessThan(type, prefix, *partition.upper);
+                            auto const aboveEnd = end && partition.lower && !lessThan(type, *partition.lower, *end);
+                            return !prefix.empty() && (belowPrefix || aboveEnd);
+                        }
+                    }
+                    return false;
+                });
             }
+            return kept;
         }
-        auto validateColumnType(const Column& column, const std::string& value) -> void {
-            if (column.type == ColumnType::NUMBER && !isNumber(value)) {
-                throw std::invalid_argument("Value '" + value + "' is not a valid number for column '" + column.name + "'");
+        auto locateRow(std::vector<std::size_t> const& offsets, int row) -> std::pair<std::size_t, int> {
+            auto const partition = static_cast<std::size_t>(std::ranges::upper_bound(offsets, static_cast<std::size_t>(row)) - offsets.begin()) - 1;
+            return {partition, row - static_cast<int>(offsets[partition])};
+        }
+        auto writePartitioning(std::ostream& file, std::vector<Table> const& tables) -> void {
+            // written after all tables, files without this section simply have no partitioned tables
+            auto const partitioned = std::ranges::count_if(tables, [](Table const& table) { return table.partitioning.has_value(); });
+            file << partitioned << '\n';
+            for (auto const& table : tables) {
+                if (!table.partitioning) {
+                    continue;
+                }
+                auto const& partitioning = *table.partitioning;
+                file << table.name << '\n';
+                file << static_cast<int>(partitioning.kind) << '\n';
+                file << partitioning.column << '\n';
+                file << partitioning.next << '\n';
+                file << partitioning.partitions.size() << '\n';
+                for (auto const& partition : partitioning.partitions) {
+                    file << partition.name << '\n';
+                    file << partition.lower.has_value() << '\n' << partition.lower.value_or("") << '\n';
+                    file << partition.upper.has_value() << '\n' << partition.upper.value_or("") << '\n';
+                }
+            }
+        }
+        auto readPartitioning(std::istream& file, std::vector<Table>& tables) -> void {
+            auto partitioned = std::string();
+            if (!std::getline(file, partitioned) || partitioned.empty()) {
+                return;
+            }
+
+            for (auto i = 0; i < std::stoi(partitioned); ++i) {
+                auto name = std::string();
+                auto kind = std::string();
+                auto next = std::string();
+                auto partitionCount = std::string();
+                auto partitioning = Partitioning();
+                std::getline(file, name);
+                std::getline(file, kind);
+                std::getline(file, partitioning.column);
+                std::getline(file, next);
+                std::getline(file, partitionCount);
+                partitioning.kind = static_cast<Partitioning::Kind>(std::stoi(kind));
+                partitioning.next = std::stoull(next);
+
+                for (auto j = 0; j < std::stoi(partitionCount); ++j) {
+                    auto partition = Partition();
+                    auto hasLower = std::string();
+                    auto lower = std::string();
+                    auto hasUpper = std::string();
+                    auto upper = std::string();
+                    std::getline(file, partition.name);
+                    std::getline(file, hasLower);
+                    std::getline(file, lower);
+                    std::getline(file, hasUpper);
+                    std::getline(file, upper);
+                    if (hasLower == "1") {
+                        partition.lower = lower;
+                    }
+                    if (hasUpper == "1") {
+                        partition.upper = upper;
+                    }
+                    partitioning.partitions.push_back(partition);
+                }
+
+                auto const table = std::ranges::find(tables, name, &Table::name);
+                if (table != tables.end()) {
+                    table->partitioning = partitioning;
+                }
+            }
+        }
+        auto getBloomHash(ColumnType type, std::string const& value) -> std::uint64_t {
+            if (type == ColumnType::TEXT) {
+                return Bloom::hashText(value);
+            }
+            // parsed like Values::numbers, so a value hashes to the number the filters compare
+            auto end = static_cast<char*>(nullptr);
+            auto const number = std::strtod(value.c_str(), &end);
+            return Bloom::hashNumber(end == value.c_str() ? std::numeric_limits<double>::quiet_NaN() : number);
+        }
+        auto buildBloom(Column& column) -> void {
+            auto const& values = std::as_const(column.data);
+            auto const chunks = (values.size() + Bloom::CHUNK_ROWS - 1) / Bloom::CHUNK_ROWS;
+            auto bloom = std::make_shared<std::vector<std::uint64_t>>(chunks * Bloom::CHUNK_WORDS);
+            for (auto row = std::size_t(0); row < values.size(); ++row) {
+                auto const hash = column.type == ColumnType::NUMBER ? Bloom::hashNumber(values.numbers()[row]) : Bloom::hashText(values[row]);
+                Bloom::insert(bloom->data() + row / Bloom::CHUNK_ROWS * Bloom::CHUNK_WORDS, hash);
+            }
+            column.bloom = bloom;
+            column.bloomPage.reset();
+        }
+        auto addToBloom(Column& column, std::size_t row) -> void {
+            // bits are only ever set, an updated row keeps the bits of its old value until the filter is rebuilt
+            if (!column.bloom) {
+                return;
             }
+            if (column.bloom.use_count() > 1) {
+                column.bloom = std::make_shared<std::vector<std::uint64_t>>(*column.bloom);
+            }
+            auto& bloom = *column.bloom;
+            auto const chunk = row / Bloom::CHUNK_ROWS;
+            if (bloom.size() < (chunk + 1) * Bloom::CHUNK_WORDS) {
+                bloom.resize((chunk + 1) * Bloom::CHUNK_WORDS);
+            }
+            Bloom::insert(bloom.data() + chunk * Bloom::CHUNK_WORDS, getBloomHash(column.type, std::as_const(column.data)[row]));
+            column.bloomPage.reset();
+        }
+        auto hasBloom(Column const& column) -> bool {
+            return column.bloom || column.bloomPage;
+        }
+        auto writeBloom(std::ostream& file, Column const& column) -> void {
+            // one line of hexadecimal words per chunk, a filter that is not loaded is copied from its page
+            if (column.bloom) {
+                auto const& bloom = *column.bloom;
+                for (auto chunk = std::size_t(0); chunk < bloom.size(); chunk += Bloom::CHUNK_WORDS) {
+                    auto line = std::string();
+                    line.reserve(Bloom::CHUNK_WORDS * 16);
+                    for (auto word = chunk; word < chunk + Bloom::CHUNK_WORDS; ++word) {
+                        fmt::format_to(std::back_inserter(line), "{:016x}", bloom[word]);
+                    }
+                    file << line << '\n';
+                }
+                return;
+            }
+
+            auto page = std::fstream(column.bloomPage->path, std::ios::in);
+            if (!page) {
+                throw std::runtime_error(fmt::format("Cannot open Bloom filter page '{}' of column '{}'.", column.bloomPage->path, column.name));
+            }
+            page.seekg(column.bloomPage->offset);
+            auto line = std::string();
+            for (auto k = std::size_t(0); k < column.bloomPage->rows && std::getline(page, line); ++k) {
+                file << line << '\n';
+            }
+        }
+        auto readBloom(std::istream& file, std::size_t chunks, std::string const& columnName) -> std::shared_ptr<std::vector<std::uint64_t>> {
+            auto bloom = std::make_shared<std::vector<std::uint64_t>>();
+            bloom->reserve(chunks * Bloom::CHUNK_WORDS);
+            auto line = std::string();
+            for (auto chunk = std::size_t(0); chunk < chunks; ++chunk) {
+                if (!std::getline(file, line) || line.size() != Bloom::CHUNK_WORDS * 16) {
+                    throw std::runtime_error(fmt::format("Bloom filter of column '{}' is corrupted.", columnName));
+                }
+                for (auto word = std::size_t(0); word < Bloom::CHUNK_WORDS; ++word) {
+                    auto value = std::uint64_t(0);
+                    std::from_chars(line.data() + word * 16, line.data() + (word + 1) * 16, value, 16);
+                    bloom->push_back(value);
+                }
+            }
+            return bloom;
+        }
+        auto getBloomChunks(Column const& column) -> std::size_t {
+            return column.bloom ? column.bloom->size() / Bloom::CHUNK_WORDS : column.bloomPage->rows;
+        }
+        auto writeBlooms(std::ostream& file, std::vector<Table> const& tables) -> void {
+            // written after the partitions of a database file
+            auto columns = std::vector<std::pair<Table const*, Column const*>>();
+            for (auto const& table : tables) {
+                for (auto const& column : table.columns) {
+                    if (hasBloom(column)) {
+                        columns.emplace_back(&table, &column);
+                    }
+                }
+            }
+            file << columns.size() << '\n';
+            for (auto const& [table, column] : columns) {
+                file << table->name << '\n';
+                file << column->name << '\n';
+                file << getBloomChunks(*column) << '\n';
+                writeBloom(file, *column);
+            }
+        }
+        auto readBlooms(std::istream& file, std::vector<Table>& tables, std::string const& path) -> void {
+            // with a path only the page of every filter in that file is kept, the words are read with the column
+            auto count = std::string();
+            if (!std::getline(file, count) || count.empty()) {
+                return;
+            }
+
+            for (auto i = 0; i < std::stoi(count); ++i) {
+                auto tableName = std::string();
+                auto columnName = std::string();
+                auto chunks = std::string();
+                std::getline(file, tableName);
+                std::getline(file, columnName);
+                std::getline(file, chunks);
+
+                auto bloom = std::shared_ptr<std::vector<std::uint64_t>>();
+                auto page = std::optional<Page>();
+                if (path.empty()) {
+                    bloom = readBloom(file, std::stoull(chunks), columnName);
+                } else {
+                    page = Page{path, file.tellg(), std::stoull(chunks)};
+                    for (auto chunk = std::size_t(0); chunk < page->rows; ++chunk) {
+                        file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    }
+                }
+
+                auto const table = std::ranges::find(tables, tableName, &Table::name);
+                if (table != tables.end() && columnExists(*table, columnName)) {
+                    auto& column = *getColumn(*table, columnName);
+                    column.bloom = bloom;
+                    column.bloomPage = page;
+                }
+            }
+        }
+        auto writeBloomPages(std::ostream& file, std::vector<Table> const& tables) -> void {
+            // catalogs and manifests only point at the filters, pages are named relative to their directory
+            auto columns = std::vector<std::pair<Table const*, Column const*>>();
+            for (auto const& table : tables) {
+                for (auto const& column : table.columns) {
+                    if (column.bloomPage) {
+                        columns.emplace_back(&table, &column);
+                    }
+                }
+            }
+            file << columns.size() << '\n';
+            for (auto const& [table, column] : columns) {
+                file << table->name << '\n';
+                file << column->name << '\n';
+                file << std::filesystem::path(column->bloomPage->path).filename().string() << '\n';
+                file << column->bloomPage->offset << '\n';
+                file << column->bloomPage->rows << '\n';
+            }
+        }
+        auto readBloomPages(std::istream& file, std::vector<Table>& tables, std::string const& directory) -> void {
+            auto count = std::string();
+            if (!std::getline(file, count) || count.empty()) {
+                return;
+            }
+
+            for (auto i = 0; i < std::stoi(count); ++i) {
+                auto tableName = std::string();
+                auto columnName = std::string();
+                auto name = std::string();
+                auto offset = std::string();
+                auto chunks = std::string();
+                std::getline(file, tableName);
+                std::getline(file, columnName);
+                std::getline(file, name);
+                std::getline(file, offset);
+                std::getline(file, chunks);
+
+                auto const table = std::ranges::find(tables, tableName, &Table::name);
+                if (table != tables.end() && columnExists(*table, columnName)) {
+                    getColumn(*table, columnName)->bloomPage = Page{(std::filesystem::path(directory) / name).string(), std::stoll(offset), std::stoull(chunks)};
+                }
+            }
+        }
+    }
+
+    Values::Values(std::vector<std::string> values) : values(std::make_shared<std::vector<std::string>>(std::move(values))) {}
+
+    auto Values::size() const -> std::size_t {
+        return values->size();
+    }
+    auto Values::empty() const -> bool {
+        return values->empty();
+    }
+    auto Values::capacity() const -> std::size_t {
+        return values->capacity();
+    }
+    auto Values::operator[](std::size_t index) const -> std::string const& {
+        return (*values)[index];
+    }
+    auto Values::begin() const -> std::vector<std::string>::const_iterator {
+        return values->cbegin();
+    }
+    auto Values::end() const -> std::vector<std::string>::const_iterator {
+        return values->cend();
+    }
+
+    auto Values::data() const -> std::string const* {
+        return values->data();
+    }
+    auto Values::parsedSize() const -> std::size_t {
+        return parsed ? parsed->capacity() : 0;
+    }
+    auto Values::numbers() const -> std::vector<double> const& {
+        // parsed once per version of the values, filters then compare plain doubles
+        if (!parsed) {
+            parsed = std::make_shared<std::vector<double>>();
+            parsed->reserve(values->size());
+            for (auto const& value : *values) {
+                auto end = static_cast<char*>(nullptr);
+                auto const number = std::strtod(value.c_str(), &end);
+                parsed->push_back(end == value.c_str() ? std::numeric_limits<double>::quiet_NaN() : number);
+            }
+        }
+        return *parsed;
+    }
+
+    auto Values::operator[](std::size_t index) -> std::string& {
+        return detach()[index];
+    }
+    auto Values::begin() -> std::vector<std::string>::iterator {
+        return detach().begin();
+    }
+    auto Values::end() -> std::vector<std::string>::iterator {
+        return detach().end();
+    }
+    auto Values::push_back(std::string const& value) -> void {
+        detach().push_back(value);
+    }
+    auto Values::erase(std::vector<std::string>::iterator position) -> std::vector<std::string>::iterator {
+        return detach().erase(position);
+    }
+    auto Values::reserve(std::size_t size) -> void {
+        detach().reserve(size);
+    }
+    auto Values::clear() -> void {
+        parsed.reset();
+        if (values.use_count() > 1) {
+            values = std::make_shared<std::vector<std::string>>();
+        } else {
+            values->clear();
+        }
+    }
+    auto Values::shrink_to_fit() -> void {
+        detach().shrink_to_fit();
+    }
+    auto Values::detach() -> std::vector<std::string>& {
+        parsed.reset();
+        // a running snapshot still reads the shared vector, so the first write after it was taken copies it
+        if (values.use_count() > 1) {
+            values = std::make_shared<std::vector<std::string>>(*values);
+        }
+        return *values;
+    }
+
+    Snapshot::~Snapshot() {
+        if (worker.joinable()) {
+            worker.join();
         }
     }
 
     auto Database::createTable(std::string const& tableName, std::vector<Column> const& columns) -> void {
         this->tables.push_back({tableName, columns});
+        for (auto& column : this->tables.back().columns) {
+            column.dirty = true;
+        }
+        touch(this->tables.back(), false);
     }
     auto Database::renameTable(std::string const& oldTableName, std::string const& newTableName) -> void {
         auto& table = *Utils::getTable(*this, oldTableName);
+        if (table.partitioning) {
+            for (auto const& partition : table.partitioning->partitions) {
+                auto& child = *Utils::getTable(*this, Utils::getPartitionTable(table, partition));
+                child.name = newTableName + "#" + partition.name;
+                touch(child, false);
+            }
+        }
         table.name = newTableName;
+        touch(table, false);
+
+        // views keep their query as text, the table named after FROM follows the rename
+        for (auto& other : tables) {
+            if (!other.view || other.view->source != oldTableName) {
+                continue;
+            }
+            auto stream = std::stringstream(other.view->query);
+            auto query = std::string();
+            auto token = std::string();
+            auto renamed = false;
+            auto from = false;
+            while (stream >> token) {
+                if (from && !renamed) {
+                    token = newTableName;
+                    renamed = true;
+                }
+                from = token == "FROM" || token == "from";
+                query += (query.empty() ? "" : " ") + token;
+            }
+            other.view->source = newTableName;
+            other.view->query = query;
+        }
     }
     auto Database::dropTable(std::string const& tableName) -> void {
-        this->tables.erase(Utils::getTable(*this, tableName));
+        auto const table = Utils::getTable(*this, tableName);
+        auto partitions = std::vector<std::string>();
+        if (table->partitioning) {
+            for (auto const& partition : table->partitioning->partitions) {
+                partitions.push_back(Utils::getPartitionTable(*table, partition));
+            }
+        }
+        this->tables.erase(table);
+        for (auto const& partition : partitions) {
+            this->tables.erase(Utils::getTable(*this, partition));
+        }
+    }
+    auto Database::partitionTable(std::string const& tableName, Partitioning const& partitioning) -> void {
+        auto& table = *Utils::getTable(*this, tableName);
+        table.partitioning = partitioning;
+        auto columns = std::vector<Column>();
+        auto partitions = std::vector<std::string>();
+        for (auto const& column : table.columns) {
+            columns.push_back({column.name, column.type});
+        }
+        for (auto const& partition : partitioning.partitions) {
+            partitions.push_back(Utils::getPartitionTable(table, partition));
+        }
+        for (auto const& partition : partitions) {
+            createTable(partition, columns);
+        }
+    }
+    auto Database::addPartition(std::string const& tableName, std::string const& bound) -> std::string {
+        auto& table = *Utils::getTable(*this, tableName);
+        auto& partitioning = *table.partitioning;
+        auto const type = Utils::getColumn(table, partitioning.column)->type;
+        auto const index = Utils::findPartition(table, bound);
+        if (!index) {
+            throw std::invalid_argument(fmt::format("No partition of table '{}' holds value '{}'.", tableName, bound));
+        }
+        auto& partition = partitioning.partitions[*index];
+        if (partition.lower && !Utils::lessThan(type, *partition.lower, bound)) {
+            throw std::invalid_argument(fmt::format("Partition '{}' already starts at '{}'.", partition.name, bound));
+        }
+
+        // the partition holding the bound is split, rows from the bound up move to the new partition
+        auto const added = Partition{fmt::format("p{}", partitioning.next++), bound, partition.upper};
+        auto const source = Utils::getPartitionTable(table, partition);
+        auto const target = Utils::getPartitionTable(table, added);
+        auto const key = partitioning.column;
+        auto columns = std::vector<Column>();
+        for (auto const& column : table.columns) {
+            columns.push_back({column.name, column.type});
+            if (Utils::hasBloom(column)) {
+                columns.back().bloom = std::make_shared<std::vector<std::uint64_t>>();
+            }
+        }
+        partition.upper = bound;
+        partitioning.partitions.insert(partitioning.partitions.begin() + static_cast<std::ptrdiff_t>(*index) + 1, added);
+        touch(table, false);
+        createTable(target, columns);
+
+        auto& from = *Utils::getTable(*this, source);
+        auto rows = Utils::getRows(from);
+        fetch(from);
+        Utils::filterRows(from, Condition{{key}, {">="}, {bound}}, rows);
+        auto moved = std::vector<std::vector<std::string>>();
+        for (auto const& column : from.columns) {
+            auto& values = moved.emplace_back();
+            values.reserve(rows.size());
+            for (auto row : rows) {
+                values.push_back(std::as_const(column.data)[row]);
+            }
+        }
+        insertRows(target, moved);
+        removeRow(source, rows);
+        return added.name;
+    }
+    auto Database::dropPartition(std::string const& tableName, std::string const& partitionName) -> void {
+        // the rows of the partition go with its table, nothing is scanned
+        auto& table = *Utils::getTable(*this, tableName);
+        auto& partitions = table.partitioning->partitions;
+        auto const partition = std::ranges::find(partitions, partitionName, &Partition::name);
+        auto const name = Utils::getPartitionTable(table, *partition);
+        partitions.erase(partition);
+        touch(table, false);
+        dropTable(name);
+    }
+    auto Database::addBloomFilter(std::string const& tableName, std::string const& columnName) -> void {
+        auto& table = *Utils::getTable(*this, tableName);
+        if (table.partitioning) {
+            for (auto const& partition : table.partitioning->partitions) {
+                addBloomFilter(Utils::getPartitionTable(table, partition), columnName);
+            }
+            // the table itself has no rows, its empty filter marks the column for partitions added later
+            auto& column = *Utils::getColumn(table, columnName);
+            column.bloom = std::make_shared<std::vector<std::uint64_t>>();
+            column.bloomPage.reset();
+            table.dirty = true;
+            return;
+        }
+        Utils::buildBloom(fetch(table, columnName));
+        // only the filter is new, the next save writes it without the values of the column
+        table.dirty = true;
+    }
+    auto Database::dropBloomFilter(std::string const& tableName, std::string const& columnName) -> void {
+        auto& table = *Utils::getTable(*this, tableName);
+        if (table.partitioning) {
+            for (auto const& partition : table.partitioning->partitions) {
+                dropBloomFilter(Utils::getPartitionTable(table, partition), columnName);
+            }
+        }
+        auto& column = *Utils::getColumn(table, columnName);
+        column.bloom.reset();
+        column.bloomPage.reset();
     }
 
     auto Database::addColumn(std::string const& tableName, Column const& column) -> void {
         auto& table = *Utils::getTable(*this, tableName);
+        if (table.partitioning) {
+            for (auto const& partition : table.partitioning->partitions) {
+                auto const name = Utils::getPartitionTable(table, partition);
+                auto const rows = Utils::getNumberOfRows(*Utils::getTable(*this, name));
+                addColumn(name, {column.name, column.type, std::vector<std::string>(rows, "")});
+            }
+        }
         table.columns.push_back(column);
+        table.columns.back().lastUsed = ++pool.tick;
+        table.columns.back().dirty = true;
+        touch(table, false);
+        evict();
     }
     auto Database::renameColumn(std::string const& tableName, std::string const& oldColumnName, std::string const& newColumnName) -> void {
         auto& table = *Utils::getTable(*this, tableName);
         auto& column = *Utils::getColumn(table, oldColumnName);
+        if (table.partitioning) {
+            for (auto const& partition : table.partitioning->partitions) {
+                renameColumn(Utils::getPartitionTable(table, partition), oldColumnName, newColumnName);
+            }
+            if (table.partitioning->column == oldColumnName) {
+                table.partitioning->column = newColumnName;
+            }
+        }
         column.name = newColumnName;
+        touch(table, false);
     }
     auto Database::removeColumn(std::string const& tableName, std::string const& columnName) -> void {
         auto& table = *Utils::getTable(*this, tableName);
+        if (table.partitioning) {
+            for (auto const& partition : table.partitioning->partitions) {
+                removeColumn(Utils::getPartitionTable(table, partition), columnName);
+            }
+        }
         auto column = Utils::getColumn(table, columnName);
         table.columns.erase(column);
+        touch(table, false);
     }
 
     auto Database::insertRow(std::string const& tableName, std::vector<std::string> const& row) -> void {
         auto& table = *Utils::getTable(*this, tableName);
+        if (table.partitioning) {
+            auto const key = Utils::getColumn(table, table.partitioning->column) - table.columns.begin();
+            auto const partition = Utils::findPartition(table, row[key]);
+            if (!partition) {
+                throw std::invalid_argument(fmt::format("No partition of table '{}' holds value '{}'.", tableName, row[key]));
+            }
+            insertRow(Utils::getPartitionTable(table, table.partitioning->partitions[*partition]), row);
+            touch(table, true);
+            return;
+        }
+        fetch(table);
         for (auto i = 0; i < table.columns.size(); ++i) {
-            table.columns[i].data.push_back(row[i]);
+            auto& column = table.columns[i];
+            column.data.push_back(row[i]);
+            column.page.reset();
+            column.dirty = true;
+            Utils::addToBloom(column, column.data.size() - 1);
+
+            Utils::updateStatistics(column, row[i]);
         }
+        touch(table, true);
     }
-    auto Database::updateRow(std::string const& tableName, std::string const& columnName, std::string const& newValue, std::string const& conditionColumnName, std::string const& condition, std::string const& conditionValue) -> void {
+    auto Database::insertRows(std::string const& tableName, std::vector<std::vector<std::string>> const& columns) -> void {
         auto& table = *Utils::getTable(*this, tableName);
-        auto& column = *Utils::getColumn(table, columnName);
+        if (table.partitioning) {
+            // every row is routed before anything is inserted, a row without a partition rejects the whole batch
+            auto const key = Utils::getColumn(table, table.partitioning->column) - table.columns.begin();
+            auto const rows = columns.empty() ? std::size_t(0) : columns[0].size();
+            auto split = std::vector<std::vector<std::vector<std::string>>>(table.partitioning->partitions.size(),
+                std::vector<std::vector<std::string>>(table.columns.size()));
+            auto targets = std::vector<std::size_t>(rows);
+            for (auto row = std::size_t(0); row < rows; ++row) {
+                auto const partition = Utils::findPartition(table, columns[key][row]);
+                if (!partition) {
+                    throw std::invalid_argument(fmt::format("No partition of table '{}' holds value '{}'.", tableName, columns[key][row]));
+                }
+                targets[row] = *partition;
+            }
+            for (auto i = std::size_t(0); i < columns.size(); ++i) {
+                for (auto row = std::size_t(0); row < rows; ++row) {
+                    split[targets[row]][i].push_back(columns[i][row]);
+                }
+            }
+            for (auto i = std::size_t(0); i < split.size(); ++i) {
+                if (!split[i][0].empty()) {
+                    insertRows(Utils::getPartitionTable(table, table.partitioning->partitions[i]), split[i]);
+                }
+            }
+            touch(table, true);
+            return;
+        }
+        fetch(table);
+        for (auto i = std::size_t(0); i < table.columns.size(); ++i) {
+            auto& column = table.columns[i];
+            column.data.reserve(column.data.size() + columns[i].size());
+            for (auto const& value : columns[i]) {
+                column.data.push_back(value);
+                Utils::updateStatistics(column, value);
+                Utils::addToBloom(column, column.data.size() - 1);
+            }
+            column.page.reset();
+            column.dirty = true;
+        }
+        touch(table, true);
+    }
+    auto Database::updateRow(std::string const& tableName, std::vector<std::string> const& columnNames, std::vector<std::string> const& newValues, std::vector<int> const& rows) -> void {
+        auto& table = *Utils::getTable(*this, tableName);
+        for (auto i = 0; i < columnNames.size(); ++i) {
+            Utils::validateColumnType(*Utils::getColumn(table, columnNames[i]), newValues[i]);
+        }
 
-        Utils::validateColumnType(column, newValue);
+        // rows were selected once up front, every column is then written in its own sequential pass
+        for (auto i = 0; i < columnNames.size(); ++i) {
+            auto& column = fetch(table, columnNames[i]);
+            for (auto row : rows) {
+                column.data[row] = newValues[i];
+                Utils::addToBloom(column, row);
+            }
+            column.page.reset();
+            column.dirty = true;
+            if (column.statistics && rows.size() * 10 > column.data.size()) {
+                column.statistics.reset();
+            }
+        }
+        touch(table, false);
+    }
+    auto Database::removeRow(std::string const& tableName, std::vector<int> const& rows) -> void {
+        auto& table = *Utils::getTable(*this, tableName);
+        if (rows.empty()) {
+            return;
+        }
+        fetch(table);
 
-        if (!conditionColumnName.empty()) {
-            auto& conditionColumn = *Utils::getColumn(table, conditionColumnName);
-            for (auto i = 0; i < conditionColumn.data.size(); ++i) {
-                if (Utils::evaluateCondition(table, conditionColumnName, condition, conditionValue, i)) {
-                    column.data[i] = newValue;
+        for (auto& column : table.columns) {
+            auto kept = std::vector<std::string>();
+            kept.reserve(column.data.size() - rows.size());
+            auto next = std::size_t(0);
+            for (auto i = std::size_t(0); i < column.data.size(); ++i) {
+                if (next < rows.size() && static_cast<std::size_t>(rows[next]) == i) {
+                    ++next;
+                } else {
+                    kept.push_back(std::move(column.data[i]));
                 }
             }
-        } else {
-            std::ranges::fill(column.data.begin(), column.data.end(), newValue);
+            column.data = Values(std::move(kept));
+            column.page.reset();
+            column.dirty = true;
+            // later rows moved to other chunks, the filters are rebuilt from the remaining values
+            if (Utils::hasBloom(column)) {
+                Utils::buildBloom(column);
+            }
+
+            if (column.statistics && column.statistics->rows > 0) {
+                auto& statistics = *column.statistics;
+                auto const remaining = column.data.size();
+                statistics.nulls = statistics.nulls * remaining / statistics.rows;
+                statistics.rows = remaining;
+                statistics.distinct = std::min(statistics.distinct, remaining - statistics.nulls);
+            }
         }
+        touch(table, false);
     }
-    auto Database::removeRow(std::string const& tableName, std::string const& conditionColumnName, const std::string& condition, std::string const& conditionValue) -> void {
-        auto& table = *Utils::getTable(*this, tableName);
-        auto indicesToRemove = std::vector<int>();
 
-        for (auto i = 0; i < table.columns[0].data.size(); ++i) {
-            if (Utils::evaluateCondition(table, conditionColumnName, condition, conditionValue, i)) {
-                indicesToRemove.push_back(i);
+    auto Database::analyze(std::string const& tableName) -> void {
+        auto& table = *Utils::getTable(*this, tableName);
+        if (table.partitioning) {
+            // the planner uses the statistics of every partition, the table only sums them up
+            for (auto& column : table.columns) {
+                column.statistics = Statistics{};
+            }
+            for (auto const& partition : table.partitioning->partitions) {
+                auto const name = Utils::getPartitionTable(table, partition);
+                analyze(name);
+                for (auto const& column : Utils::getTable(*this, name)->columns) {
+                    auto& statistics = *Utils::getColumn(table, column.name)->statistics;
+                    statistics.rows += column.statistics->rows;
+                    statistics.nulls += column.statistics->nulls;
+                    statistics.distinct += column.statistics->distinct;
+                }
             }
+            return;
         }
+        auto const buckets = std::size_t(16);
+
+        auto summarize = [buckets](auto& sorted, Statistics& statistics) -> void {
+            std::ranges::sort(sorted);
+            statistics.distinct = sorted.empty() ? 0 : 1;
+            for (auto i = std::size_t(1); i < sorted.size(); ++i) {
+                if (sorted[i] != sorted[i - 1]) {
+                    ++statistics.distinct;
+                }
+            }
+            for (auto bucket = std::size_t(1); !sorted.empty() && bucket <= buckets; ++bucket) {
+                statistics.bounds.push_back(fmt::format("{}", sorted[std::max<std::size_t>(bucket * sorted.size() / buckets, 1) - 1]));
+            }
+        };
 
         for (auto& column : table.columns) {
-            for (auto& offset : std::ranges::reverse_view(indicesToRemove)) {
-                column.data.erase(column.data.begin() + offset);
+            auto const& values = std::as_const(fetch(table, column.name).data);
+            auto statistics = Statistics{values.size()};
+
+            if (column.type == ColumnType::NUMBER) {
+                auto sorted = std::vector<double>();
+                sorted.reserve(values.size());
+                for (auto number : values.numbers()) {
+                    if (std::isnan(number)) {
+                        ++statistics.nulls;
+                    } else {
+                        sorted.push_back(number);
+                    }
+                }
+                summarize(sorted, statistics);
+            } else {
+                auto sorted = std::vector<std::string>();
+                sorted.reserve(values.size());
+                for (auto const& value : values) {
+                    if (value.empty()) {
+                        ++statistics.nulls;
+                    } else {
+                        sorted.push_back(value);
+                    }
+                }
+                summarize(sorted, statistics);
             }
+            column.statistics = statistics;
+            // only the statistics are kept, the column is unpinned so the next fetch can evict it
+            pool.statement = pool.tick;
         }
     }
 
-    auto Database::writeToFile(std::fstream& file) const -> void {
+    auto Database::touch(Table& table, bool append) -> void {
+        // versions come from one database wide counter, so a dropped and recreated table never repeats one
+        table.dirty = true;
+        table.version = ++version;
+        if (!append) {
+            table.rewriteVersion = table.version;
+        }
+    }
+
+    auto Database::writeToFile(std::fstream& file, std::atomic<std::size_t>* written) const -> void {
         file << this->name << '\n';
         file << this->tables.size() << '\n';
 
@@ -253,15 +1312,78 @@ namespace Db {
             for (auto const& column : table.columns) {
                 file << column.name << '\n';
                 file << static_cast<int>(column.type) << '\n';
-                file << column.data.size() << '\n';
-                for (auto const& value : column.data) {
-                    file << value << '\n';
+                file << Utils::getNumberOfValues(column) << '\n';
+                Utils::writeValues(file, column);
+                if (written) {
+                    written->fetch_add(Utils::getNumberOfValues(column), std::memory_order_relaxed);
                 }
             }
         }
+        Utils::writePartitioning(file, tables);
+        Utils::writeBlooms(file, tables);
+    }
+    auto Database::saveToFile(std::string const& filename, std::atomic<std::size_t>* written) const -> void {
+        // the previous file stays intact until the new one is complete and on disk
+        auto const temporary = filename + ".tmp";
+        auto file = std::fstream(temporary, std::ios::out | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error(fmt::format("Cannot open file '{}' for writing.", temporary));
+        }
+
+        writeToFile(file, written);
+        file.close();
+        if (file.fail()) {
+            std::filesystem::remove(temporary);
+            throw std::runtime_error(fmt::format("Cannot write file '{}'.", temporary));
+        }
+
+        Utils::syncFile(temporary);
+        std::filesystem::rename(temporary, filename);
+        auto const directory = std::filesystem::absolute(filename).parent_path();
+        Utils::syncFile(directory.string());
+    }
+    auto Database::saveInBackground(std::string const& filename) -> void {
+        if (snapshot && snapshot->state == Snapshot::State::RUNNING) {
+            throw std::runtime_error(fmt::format("Snapshot to file '{}' is still running.", snapshot->filename));
+        }
+        waitForSnapshot();
+
+        snapshot = std::make_shared<Snapshot>();
+        snapshot->filename = filename;
+        snapshot->database.name = name;
+        snapshot->database.tables = tables;
+        for (auto const& table : tables) {
+            for (auto const& column : table.columns) {
+                snapshot->total += Utils::getNumberOfValues(column);
+            }
+        }
+
+        snapshot->worker = std::thread([state = snapshot.get()]() -> void {
+            auto result = Snapshot::State::FINISHED;
+            try {
+                state->database.saveToFile(state->filename, &state->written);
+            } catch (std::exception const& e) {
+                std::filesystem::remove(state->filename + ".tmp");
+                state->error = e.what();
+                result = Snapshot::State::FAILED;
+            }
+            // the copied tables share every column, keeping them would make the next write to any column copy it
+            state->database.tables.clear();
+            state->database.tables.shrink_to_fit();
+            state->state = result;
+        });
+    }
+    auto Database::waitForSnapshot() -> void {
+        if (snapshot && snapshot->worker.joinable()) {
+            snapshot->worker.join();
+        }
     }
     auto Database::readFromFile(std::fstream& file) -> void {
+        this->resetPool();
         this->tables.clear();
+        this->directory.clear();
+        this->generation = 0;
+        this->results.clear();
         std::getline(file, this->name);
 
         auto tableCount = std::string();
@@ -282,25 +1404,415 @@ namespace Db {
                 std::getline(file, columnType);
                 column.type = static_cast<ColumnType>(std::stoi(columnType));
 
-                auto dataSize = std::string();
-                std::getline(file, dataSize);
+                auto dataSize = std::string();
+                std::getline(file, dataSize);
+
+                for(auto k = 0; k < std::stoi(dataSize); ++k) {
+                    auto value = std::string();
+                    std::getline(file, value);
+                    column.data.push_back(value);
+                }
+                table.columns.push_back(column);
+            }
+            this->tables.push_back(table);
+        }
+        Utils::readPartitioning(file, this->tables);
+        Utils::readBlooms(file, this->tables);
+    }
+    auto Database::openFromFile(std::string const& filename, std::size_t capacity) -> void {
+        auto file = std::fstream(filename, std::ios::in);
+        if (!file) {
+            throw std::runtime_error(fmt::format("Cannot open file '{}' for reading.", filename));
+        }
+
+        auto name = std::string();
+        auto tables = std::vector<Table>();
+
+        // the catalog keeps the offset of every column, so one written for this data file lets us skip its scan; size
+        // and modification time identify the file, and the same stamp closes the catalog, so a replaced data file or a
+        // cut off catalog is never trusted
+        auto const catalogName = filename + ".catalog";
+        auto const stamp = fmt::format("{} {}", std::filesystem::file_size(filename),
+            std::filesystem::last_write_time(filename).time_since_epoch().count());
+        auto cataloged = false;
+        auto catalog = std::fstream(catalogName, std::ios::in);
+        auto line = std::string();
+        if (catalog && std::getline(catalog, line) && line == stamp) {
+            try {
+                std::getline(catalog, name);
+                auto tableCount = std::string();
+                std::getline(catalog, tableCount);
+
+                for(auto i = 0; i < std::stoi(tableCount); ++i) {
+                    auto table = Table{""};
+                    std::getline(catalog, table.name);
+                    auto columnCount = std::string();
+                    std::getline(catalog, columnCount);
+
+                    for(auto j = 0; j < std::stoi(columnCount); ++j) {
+                        auto column = Column{"", ColumnType::TEXT, {}, Page{filename}, false};
+                        auto columnType = std::string();
+                        auto offset = std::string();
+                        auto rows = std::string();
+                        std::getline(catalog, column.name);
+                        std::getline(catalog, columnType);
+                        std::getline(catalog, offset);
+                        std::getline(catalog, rows);
+                        column.type = static_cast<ColumnType>(std::stoi(columnType));
+                        column.page->offset = std::stoll(offset);
+                        column.page->rows = std::stoull(rows);
+                        table.columns.push_back(column);
+                    }
+                    tables.push_back(table);
+                }
+                Utils::readPartitioning(catalog, tables);
+                Utils::readBloomPages(catalog, tables, std::filesystem::path(filename).parent_path().string());
+                cataloged = std::getline(catalog, line) && line == stamp;
+            } catch (std::exception const&) {
+                // the catalog is only a cache, a damaged one means the data file is scanned instead
+            }
+        }
+        catalog.close();
+
+        if (!cataloged) {
+            name.clear();
+            tables.clear();
+            std::getline(file, name);
+            auto tableCount = std::string();
+            std::getline(file, tableCount);
+
+            for(auto i = 0; i < std::stoi(tableCount); ++i) {
+                auto table = Table{""};
+                std::getline(file, table.name);
+                auto columnCount = std::string();
+                std::getline(file, columnCount);
+
+                for(auto j = 0; j < std::stoi(columnCount); ++j) {
+                    auto column = Column{"", ColumnType::TEXT, {}, Page{filename}, false};
+                    std::getline(file, column.name);
+                    auto columnType = std::string();
+                    std::getline(file, columnType);
+                    column.type = static_cast<ColumnType>(std::stoi(columnType));
+                    auto dataSize = std::string();
+                    std::getline(file, dataSize);
+                    column.page->rows = std::stoull(dataSize);
+                    column.page->offset = file.tellg();
+
+                    for(auto k = std::size_t(0); k < column.page->rows; ++k) {
+                        file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    }
+                    table.columns.push_back(column);
+                }
+                tables.push_back(table);
+            }
+            Utils::readPartitioning(file, tables);
+            Utils::readBlooms(file, tables, filename);
+
+            // written like the database file, a crash leaves the previous catalog or none at all
+            auto const temporary = catalogName + ".tmp";
+            catalog = std::fstream(temporary, std::ios::out | std::ios::trunc);
+            if (catalog) {
+                catalog << stamp << '\n';
+                catalog << name << '\n';
+                catalog << tables.size() << '\n';
+                for (auto const& table : tables) {
+                    catalog << table.name << '\n';
+                    catalog << table.columns.size() << '\n';
+                    for (auto const& column : table.columns) {
+                        catalog << column.name << '\n';
+                        catalog << static_cast<int>(column.type) << '\n';
+                        catalog << column.page->offset << '\n';
+                        catalog << column.page->rows << '\n';
+                    }
+                }
+                Utils::writePartitioning(catalog, tables);
+                Utils::writeBloomPages(catalog, tables);
+                catalog << stamp << '\n';
+                catalog.close();
+                if (catalog.fail()) {
+                    std::filesystem::remove(temporary);
+                } else {
+                    Utils::syncFile(temporary);
+                    std::filesystem::rename(temporary, catalogName);
+                }
+            }
+        }
+
+        this->resetPool();
+        std::filesystem::remove_all(filename + ".pages");
+        this->name = name;
+        this->tables = tables;
+        this->directory.clear();
+        this->generation = 0;
+        this->results.clear();
+        this->pool.file = filename;
+        this->pool.capacity = capacity;
+    }
+
+    auto Database::saveToDirectory(std::string const& path) -> void {
+        std::filesystem::create_directories(path);
+        auto const directory = std::filesystem::canonical(path);
+        auto const manifest = directory / "MANIFEST";
+
+        // segments are only valid for the directory they were written to, anything else gets a full save
+        auto const full = this->directory != directory.string() || !std::filesystem::exists(manifest);
+        if (full && std::filesystem::exists(manifest)) {
+            // the directory was written by another database, its segments are numbered up to its own generation
+            auto current = std::fstream(manifest, std::ios::in);
+            auto line = std::string();
+            std::getline(current, line);
+            if (std::getline(current, line) && !line.empty() && line.find_first_not_of("0123456789") == std::string::npos) {
+                generation = std::max(generation, static_cast<std::size_t>(std::stoull(line)));
+            }
+        }
+
+        // a new name per write keeps the files of the current manifest intact until it is replaced
+        auto const nextFile = [this, &directory](std::string const& extension) -> std::string {
+            auto name = std::string();
+            do {
+                name = fmt::format("{}.{}", ++generation, extension);
+            } while (std::filesystem::exists(directory / name));
+            return (directory / name).string();
+        };
+
+        for (auto& table : tables) {
+            if (!full && !table.dirty) {
+                continue;
+            }
+            for (auto& column : table.columns) {
+                if (full || column.dirty || column.segment.empty()) {
+                    auto const segmentPath = nextFile("seg");
+                    auto file = std::fstream(segmentPath, std::ios::out | std::ios::trunc);
+                    if (!file) {
+                        throw std::runtime_error(fmt::format("Cannot open file '{}' for writing.", segmentPath));
+                    }
+                    Utils::writeValues(file, column);
+                    file.close();
+                    Utils::syncFile(segmentPath);
+                    column.segment = std::filesystem::path(segmentPath).filename().string();
+                    column.page = Page{segmentPath, 0, Utils::getNumberOfValues(column)};
+                }
+
+                // the filter has its own file, written only when it changed since it was last saved here
+                if (Utils::hasBloom(column) &&
+                    (full || !column.bloomPage || std::filesystem::path(column.bloomPage->path).parent_path() != directory)) {
+                    auto const bloomPath = nextFile("bloom");
+                    auto file = std::fstream(bloomPath, std::ios::out | std::ios::trunc);
+                    if (!file) {
+                        throw std::runtime_error(fmt::format("Cannot open file '{}' for writing.", bloomPath));
+                    }
+                    Utils::writeBloom(file, column);
+                    file.close();
+                    Utils::syncFile(bloomPath);
+                    column.bloomPage = Page{bloomPath, 0, Utils::getBloomChunks(column)};
+                }
+            }
+        }
+
+        auto const temporary = (directory / "MANIFEST.tmp").string();
+        auto file = std::fstream(temporary, std::ios::out | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error(fmt::format("Cannot open file '{}' for writing.", temporary));
+        }
+        file << name << '\n';
+        file << generation << '\n';
+        file << tables.size() << '\n';
+        for (auto const& table : tables) {
+            file << table.name << '\n';
+            file << table.columns.size() << '\n';
+            for (auto const& column : table.columns) {
+                file << column.name << '\n';
+                file << static_cast<int>(column.type) << '\n';
+                file << Utils::getNumberOfValues(column) << '\n';
+                file << column.segment << '\n';
+            }
+        }
+        Utils::writePartitioning(file, tables);
+        Utils::writeBloomPages(file, tables);
+        file.close();
+        Utils::syncFile(temporary);
+        std::filesystem::rename(temporary, manifest);
+        Utils::syncFile(directory.string());
+
+        auto segments = std::set<std::string>();
+        for (auto& table : tables) {
+            for (auto& column : table.columns) {
+                segments.insert(column.segment);
+                if (column.bloomPage) {
+                    segments.insert(std::filesystem::path(column.bloomPage->path).filename().string());
+                }
+                column.dirty = false;
+            }
+            table.dirty = false;
+        }
+        for (auto const& entry : std::filesystem::directory_iterator(directory)) {
+            auto const extension = entry.path().extension();
+            if ((extension == ".seg" || extension == ".bloom") && !segments.contains(entry.path().filename().string())) {
+                std::filesystem::remove(entry.path());
+            }
+        }
+        this->directory = directory.string();
+    }
+    auto Database::openFromDirectory(std::string const& path, std::size_t capacity) -> void {
+        auto const directory = std::filesystem::canonical(path);
+        auto const manifestName = (directory / "MANIFEST").string();
+        auto manifest = std::fstream(manifestName, std::ios::in);
+        if (!manifest) {
+            throw std::runtime_error(fmt::format("Cannot open file '{}' for reading.", manifestName));
+        }
+
+        auto name = std::string();
+        auto generation = std::string();
+        auto tableCount = std::string();
+        auto tables = std::vector<Table>();
+        std::getline(manifest, name);
+        std::getline(manifest, generation);
+        std::getline(manifest, tableCount);
+
+        for(auto i = 0; i < std::stoi(tableCount); ++i) {
+            auto table = Table{""};
+            table.dirty = false;
+            std::getline(manifest, table.name);
+            auto columnCount = std::string();
+            std::getline(manifest, columnCount);
+
+            for(auto j = 0; j < std::stoi(columnCount); ++j) {
+                auto column = Column{"", ColumnType::TEXT, {}, Page{}, false};
+                auto columnType = std::string();
+                auto rows = std::string();
+                std::getline(manifest, column.name);
+                std::getline(manifest, columnType);
+                std::getline(manifest, rows);
+                std::getline(manifest, column.segment);
+                column.type = static_cast<ColumnType>(std::stoi(columnType));
+                column.page->path = (directory / column.segment).string();
+                column.page->rows = std::stoull(rows);
+                column.dirty = false;
+                table.columns.push_back(column);
+            }
+            tables.push_back(table);
+        }
+        Utils::readPartitioning(manifest, tables);
+        Utils::readBloomPages(manifest, tables, directory.string());
+
+        this->resetPool();
+        std::filesystem::remove_all(directory.string() + ".pages");
+        this->name = name;
+        this->tables = tables;
+        this->directory = directory.string();
+        this->generation = std::stoull(generation);
+        this->results.clear();
+        this->pool.file = directory.string();
+        this->pool.capacity = capacity;
+    }
+
+    auto Database::fetch(Table& table) -> void {
+        for (auto const& column : table.columns) {
+            fetch(table, column.name);
+        }
+    }
+    auto Database::fetch(Table& table, std::string const& columnName) -> Column& {
+        auto& column = *Utils::getColumn(table, columnName);
+        column.lastUsed = ++pool.tick;
+        if (column.resident) {
+            return column;
+        }
+
+        auto file = std::fstream(column.page->path, std::ios::in);
+        if (!file) {
+            throw std::runtime_error(fmt::format("Cannot open page '{}' of column '{}'.", column.page->path, column.name));
+        }
+        file.seekg(column.page->offset);
+
+        column.data.reserve(column.page->rows);
+        auto value = std::string();
+        for (auto k = std::size_t(0); k < column.page->rows && std::getline(file, value); ++k) {
+            column.data.push_back(value);
+        }
+        if (column.bloomPage) {
+            auto bloom = std::fstream(column.bloomPage->path, std::ios::in);
+            if (!bloom) {
+                throw std::runtime_error(fmt::format("Cannot open Bloom filter page '{}' of column '{}'.", column.bloomPage->path, column.name));
+            }
+            bloom.seekg(column.bloomPage->offset);
+            column.bloom = Utils::readBloom(bloom, column.bloomPage->rows, column.name);
+        }
+        column.resident = true;
+
+        evict();
+        return column;
+    }
+    auto Database::evict() -> void {
+        if (pool.capacity == 0) {
+            return;
+        }
+
+        auto used = std::size_t(0);
+        for (auto const& table : tables) {
+            for (auto const& column : table.columns) {
+                used += Utils::estimateColumnBytes(column);
+            }
+        }
+
+        while (used > pool.capacity) {
+            // columns touched by the running statement are pinned, the pool overcommits rather than evicting them
+            auto victim = static_cast<Column*>(nullptr);
+            for (auto& table : tables) {
+                for (auto& column : table.columns) {
+                    if (column.resident && column.lastUsed <= pool.statement && (!victim || column.lastUsed < victim->lastUsed)) {
+                        victim = &column;
+                    }
+                }
+            }
+            if (!victim) {
+                return;
+            }
 
-                for(auto k = 0; k < std::stoi(dataSize); ++k) {
-                    auto value = std::string();
-                    std::getline(file, value);
-                    column.data.push_back(value);
+            if (!victim->page) {
+                auto const directory = std::filesystem::path(pool.file + ".pages");
+                std::filesystem::create_directories(directory);
+                auto const path = (directory / fmt::format("{}.page", ++pool.spills)).string();
+                auto file = std::fstream(path, std::ios::out | std::ios::trunc);
+                if (!file) {
+                    throw std::runtime_error(fmt::format("Cannot write page '{}' of column '{}'.", path, victim->name));
                 }
-                table.columns.push_back(column);
+                for (auto const& value : std::as_const(victim->data)) {
+                    file << value << '\n';
+                }
+                victim->page = Page{path, 0, victim->data.size()};
             }
-            this->tables.push_back(table);
+            if (victim->bloom && !victim->bloomPage) {
+                auto const directory = std::filesystem::path(pool.file + ".pages");
+                std::filesystem::create_directories(directory);
+                auto const path = (directory / fmt::format("{}.bloom", ++pool.spills)).string();
+                auto file = std::fstream(path, std::ios::out | std::ios::trunc);
+                if (!file) {
+                    throw std::runtime_error(fmt::format("Cannot write Bloom filter page '{}' of column '{}'.", path, victim->name));
+                }
+                Utils::writeBloom(file, *victim);
+                victim->bloomPage = Page{path, 0, Utils::getBloomChunks(*victim)};
+            }
+
+            used -= Utils::estimateColumnBytes(*victim);
+            victim->data.clear();
+            victim->data.shrink_to_fit();
+            victim->bloom.reset();
+            victim->resident = false;
         }
     }
+    auto Database::resetPool() -> void {
+        if (!pool.file.empty() && pool.spills > 0) {
+            std::filesystem::remove_all(pool.file + ".pages");
+        }
+        pool = BufferPool{};
+    }
 
     auto Parser::parseQuery(std::string const& query) -> void {
         auto stream = std::stringstream(query);
         auto command = std::string();
         stream >> command;
         std::ranges::transform(command.begin(), command.end(), command.begin(), toupper);
+        database.pool.statement = database.pool.tick;
 
         if (command == "CREATE_TABLE") {
             auto tableName = std::string();
@@ -309,10 +1821,28 @@ namespace Db {
                 throw std::invalid_argument(fmt::format("Table '{}' already exists in database.", tableName));
             }
 
+            if (tableName.find('#') != std::string::npos) {
+                throw std::invalid_argument(fmt::format("Table name '{}' cannot contain '#'.", tableName));
+            }
+
             auto columns = std::vector<Column>();
             auto columnName = std::string();
             auto type = std::string();
+            auto partitioning = std::optional<Partitioning>();
             while (stream >> columnName >> type) {
+                auto keyword = columnName;
+                std::ranges::transform(keyword.begin(), keyword.end(), keyword.begin(), toupper);
+                if (keyword == "PARTITION_BY") {
+                    // RANGE(column) bound1 bound2 ... or HASH(column) count
+                    auto const open = type.find('(');
+                    auto kind = type.substr(0, open);
+                    std::ranges::transform(kind.begin(), kind.end(), kind.begin(), toupper);
+                    if (open == std::string::npos || !type.ends_with(')') || (kind != "RANGE" && kind != "HASH")) {
+                        throw std::invalid_argument(fmt::format("Partitioning '{}' is not valid, use RANGE(column) or HASH(column).", type));
+                    }
+                    partitioning = Partitioning{kind == "RANGE" ? Partitioning::Kind::RANGE : Partitioning::Kind::HASH, type.substr(open + 1, type.size() - open - 2)};
+                    break;
+                }
                 std::ranges::transform(type.begin(), type.end(), type.begin(), toupper);
                 auto columnType = (type == "NUMBER" ? ColumnType::NUMBER : ColumnType::TEXT);
                 columns.push_back({columnName, columnType});
@@ -321,8 +1851,88 @@ namespace Db {
                 throw std::invalid_argument(fmt::format("Columns should have unique names."));
             }
 
+            if (partitioning) {
+                auto const key = std::ranges::find(columns, partitioning->column, &Column::name);
+                if (key == columns.end()) {
+                    throw std::invalid_argument(fmt::format("Column '{}' does not exist in table '{}'.", partitioning->column, tableName));
+                }
+                auto arguments = std::vector<std::string>();
+                auto argument = std::string();
+                while (stream >> argument) {
+                    arguments.push_back(argument);
+                }
+
+                if (partitioning->kind == Partitioning::Kind::HASH) {
+                    if (arguments.size() != 1 || arguments[0].find_first_not_of("0123456789") != std::string::npos || std::stoull(arguments[0]) == 0) {
+                        throw std::invalid_argument("HASH partitioning needs the number of partitions.");
+                    }
+                    for (auto i = std::size_t(0); i < std::stoull(arguments[0]); ++i) {
+                        partitioning->partitions.push_back({fmt::format("p{}", i)});
+                    }
+                } else {
+                    for (auto i = std::size_t(0); i < arguments.size(); ++i) {
+                        if (key->type == ColumnType::NUMBER && !Utils::isNumber(arguments[i])) {
+                            throw std::invalid_argument(fmt::format("Value '{}' is not a valid number for column '{}'.", arguments[i], key->name));
+                        }
+                        if (i > 0 && !Utils::lessThan(key->type, arguments[i - 1], arguments[i])) {
+                            throw std::invalid_argument("Bounds of RANGE partitions must be increasing.");
+                        }
+                    }
+                    // n bounds make n + 1 partitions, the first and the last one are unbounded
+                    for (auto i = std::size_t(0); i <= arguments.size(); ++i) {
+                        auto partition = Partition{fmt::format("p{}", i)};
+                        if (i > 0) {
+                            partition.lower = arguments[i - 1];
+                        }
+                        if (i < arguments.size()) {
+                            partition.upper = arguments[i];
+                        }
+                        partitioning->partitions.push_back(partition);
+                    }
+                }
+                partitioning->next = partitioning->partitions.size();
+            }
+
             database.createTable(tableName, columns);
-            fmt::println("Table '{}' created in database.", tableName);
+            if (partitioning) {
+                database.partitionTable(tableName, *partitioning);
+                fmt::println("Table '{}' created in database with '{}' partitions.", tableName, partitioning->partitions.size());
+            } else {
+                fmt::println("Table '{}' created in database.", tableName);
+            }
+        }
+        else if (command == "CREATE_MATERIALIZED_VIEW") {
+            auto viewName = std::string();
+            auto as = std::string();
+            auto select = std::string();
+            stream >> viewName >> as >> select;
+            std::ranges::transform(as.begin(), as.end(), as.begin(), toupper);
+            std::ranges::transform(select.begin(), select.end(), select.begin(), toupper);
+            if (as != "AS" || select != "SELECT") {
+                throw std::invalid_argument("Materialized view has to be defined with 'AS SELECT ...'.");
+            }
+            if (Utils::tableExists(database, viewName)) {
+                throw std::invalid_argument(fmt::format("Table '{}' already exists in database.", viewName));
+            }
+            if (viewName.find('#') != std::string::npos) {
+                throw std::invalid_argument(fmt::format("Table name '{}' cannot contain '#'.", viewName));
+            }
+
+            auto const query = Utils::normalizeQuery(Utils::getRemainingQuery(stream));
+            auto selectStream = std::stringstream(query);
+            auto const result = executeSelectQuery(selectStream);
+            auto& source = *Utils::getTable(database, result.table);
+
+            auto columns = materialize(result);
+            if(!Utils::uniqueColumns(columns)) {
+                throw std::invalid_argument(fmt::format("Columns should have unique names."));
+            }
+
+            auto const ordered = query.find("ORDER_BY") != std::string::npos || query.find("order_by") != std::string::npos;
+            auto const view = View{source.name, query, source.version, source.rewriteVersion, Utils::getNumberOfRows(source), ordered};
+            database.createTable(viewName, columns);
+            database.tables.back().view = view;
+            fmt::println("Materialized view '{}' created in database.", viewName);
         }
         else if (command == "RENAME_TABLE") {
             auto oldTableName = std::string();
@@ -331,11 +1941,18 @@ namespace Db {
                 throw std::invalid_argument(fmt::format("Table '{}' does not exists in database.", oldTableName));
             }
 
+            if (Utils::isPartition(database, oldTableName)) {
+                throw std::invalid_argument(fmt::format("Table '{}' is a partition and cannot be renamed.", oldTableName));
+            }
+
             auto newTableName = std::string();
             stream >> newTableName;
             if (Utils::tableExists(database, newTableName)) {
                 throw std::invalid_argument(fmt::format("Table '{}' already exists in database.", newTableName));
             }
+            if (newTableName.find('#') != std::string::npos) {
+                throw std::invalid_argument(fmt::format("Table name '{}' cannot contain '#'.", newTableName));
+            }
 
             database.renameTable(oldTableName, newTableName);
             fmt::println("Table '{}' renamed to '{}'.", oldTableName, newTableName);
@@ -347,6 +1964,10 @@ namespace Db {
                 throw std::invalid_argument(fmt::format("Table '{}' does not exists in database.", tableName));
             }
 
+            if (Utils::isPartition(database, tableName)) {
+                throw std::invalid_argument(fmt::format("Table '{}' is a partition, use DROP_PARTITION to drop it.", tableName));
+            }
+
             database.dropTable(tableName);
             fmt::println("Table '{}' dropped from database.", tableName);
         }
@@ -361,6 +1982,12 @@ namespace Db {
             }
 
             auto table = Utils::getTable(database, tableName);
+            if (table->view) {
+                throw std::invalid_argument(fmt::format("Table '{}' is a materialized view and cannot be altered.", tableName));
+            }
+            if (Utils::isPartition(database, tableName)) {
+                throw std::invalid_argument(fmt::format("Table '{}' is a partition and can only be altered through its table.", tableName));
+            }
 
             if (operation == "ADD_COLUMN") {
                 auto columnName = std::string();
@@ -374,10 +2001,7 @@ namespace Db {
                 std::ranges::transform(type.begin(), type.end(), type.begin(), toupper);
                 auto columnType = (type == "NUMBER" ? ColumnType::NUMBER : ColumnType::TEXT);
 
-                auto data = std::vector<std::string>();
-                if(!table->columns.empty() && !table->columns[0].data.empty()) {
-                    data = std::vector<std::string>(table->columns[0].data.size(), "");
-                }
+                auto data = std::vector<std::string>(Utils::getNumberOfRows(*table), "");
 
                 database.addColumn(tableName, {columnName, columnType, data});
                 fmt::println("Column '{}' added to table '{}.", columnName, tableName);
@@ -404,6 +2028,9 @@ namespace Db {
                 if(!Utils::columnExists(*table, columnName)) {
                     throw std::invalid_argument(fmt::format("Column '{}' does not exists in table '{}'.", columnName, tableName));
                 }
+                if(table->partitioning && table->partitioning->column == columnName) {
+                    throw std::invalid_argument(fmt::format("Column '{}' is the partition key of table '{}' and cannot be removed.", columnName, tableName));
+                }
 
                 database.removeColumn(tableName, columnName);
                 fmt::println("Column '{}' removed from table '{}'.", columnName, tableName);
@@ -435,34 +2062,135 @@ namespace Db {
                 fmt::println("Row inserted to table '{}'.", tableName);
             }
             else if (operation == "UPDATE_ROW") {
-                auto columnName = std::string();
-                auto value = std::string();
+                auto columnNames = std::vector<std::string>();
+                auto values = std::vector<std::string>();
                 auto where = std::string();
-                auto conditionalColumnName = std::string();
-                auto conditionalOperation = std::string();
-                auto conditionalValue = std::string();
-                stream >> columnName >> value >> where  >> conditionalColumnName >> conditionalOperation >> conditionalValue;
+                auto token = std::string();
+                stream >> token;
+
+                auto set = token;
+                std::ranges::transform(set.begin(), set.end(), set.begin(), toupper);
+                if (set == "SET") {
+                    while (stream >> token) {
+                        if (token == "WHERE" || token == "where") {
+                            where = token;
+                            break;
+                        }
+                        if (token == ",") {
+                            continue;
+                        }
+                        auto value = std::string();
+                        if (!(stream >> value) || value == "WHERE" || value == "where") {
+                            throw std::invalid_argument(fmt::format("New value for column '{}' must be provided for row update.", token));
+                        }
+                        if (value.ends_with(',')) {
+                            value.pop_back();
+                        }
+                        columnNames.push_back(token);
+                        values.push_back(value);
+                    }
+                } else {
+                    auto value = std::string();
+                    stream >> value >> where;
+                    if (value == "WHERE" || value == "where") {
+                        throw std::invalid_argument(fmt::format("New value for column '{}' must be provided for row update.", token));
+                    }
+                    columnNames.push_back(token);
+                    values.push_back(value);
+                }
+
+                if (columnNames.empty() || std::ranges::any_of(values, [](std::string const& value) { return value.empty(); })) {
+                    throw std::invalid_argument("Column name and new value must be provided for row update.");
+                }
+                for (auto const& columnName : columnNames) {
+                    if (!Utils::columnExists(*table, columnName)) {
+                        throw std::invalid_argument(fmt::format("Column '{}' does not exist in table '{}'.", columnName, tableName));
+                    }
+                    if (std::ranges::count(columnNames, columnName) > 1) {
+                        throw std::invalid_argument(fmt::format("Column '{}' is updated more than once.", columnName));
+                    }
+                    if (table->partitioning && table->partitioning->column == columnName) {
+                        throw std::invalid_argument(fmt::format("Column '{}' is the partition key of table '{}' and cannot be updated.", columnName, tableName));
+                    }
+                }
+
+                auto condition = std::optional<Condition>();
+                if (where == "WHERE" || where == "where") {
+                    condition = readCondition(stream);
+                } else if (!where.empty()) {
+                    throw std::invalid_argument(fmt::format("Expected WHERE but got '{}'.", where));
+                }
 
-                database.updateRow(tableName, columnName, value, conditionalColumnName, conditionalOperation, conditionalValue);
+                for (auto const& [target, rows] : selectRows(*table, condition)) {
+                    database.updateRow(target->name, columnNames, values, rows);
+                }
+                if (table->partitioning) {
+                    database.touch(*table, false);
+                }
                 fmt::println("Row updated in table '{}'.", tableName);
             }
             else if (operation == "DELETE_ROW") {
                 auto where = std::string();
-                auto conditionalColumnName = std::string();
-                auto conditionalOperation = std::string();
-                auto conditionalValue = std::string();
-                stream >> where >> conditionalColumnName >> conditionalOperation >> conditionalValue;
+                stream >> where;
+                if (where != "WHERE" && where != "where") {
+                    throw std::invalid_argument("Condition must be provided for row deletion.");
+                }
 
-                if (conditionalColumnName.empty() || conditionalValue.empty()) {
-                    throw std::invalid_argument("Condition column name and value must be provided for row deletion.");
+                for (auto const& [target, rows] : selectRows(*table, readCondition(stream))) {
+                    database.removeRow(target->name, rows);
                 }
-                if (!Utils::columnExists(*table, conditionalColumnName)) {
-                    throw std::invalid_argument(fmt::format("Condition column '{}' does not exist.", conditionalColumnName));
+                if (table->partitioning) {
+                    database.touch(*table, false);
                 }
-
-                database.removeRow(tableName, conditionalColumnName, conditionalOperation, conditionalValue);
                 fmt::println("Row deleted from table '{}'.", tableName);
             }
+            else if (operation == "ADD_BLOOM_FILTER" || operation == "DROP_BLOOM_FILTER") {
+                auto columnName = std::string();
+                stream >> columnName;
+                if(!Utils::columnExists(*table, columnName)) {
+                    throw std::invalid_argument(fmt::format("Column '{}' does not exists in table '{}'.", columnName, tableName));
+                }
+
+                auto const exists = Utils::hasBloom(*Utils::getColumn(*table, columnName));
+                if (operation == "ADD_BLOOM_FILTER") {
+                    if (exists) {
+                        throw std::invalid_argument(fmt::format("Column '{}' in table '{}' already has a Bloom filter.", columnName, tableName));
+                    }
+                    database.addBloomFilter(tableName, columnName);
+                    fmt::println("Bloom filter added to column '{}' in table '{}'.", columnName, tableName);
+                } else {
+                    if (!exists) {
+                        throw std::invalid_argument(fmt::format("Column '{}' in table '{}' does not have a Bloom filter.", columnName, tableName));
+                    }
+                    database.dropBloomFilter(tableName, columnName);
+                    fmt::println("Bloom filter dropped from column '{}' in table '{}'.", columnName, tableName);
+                }
+            }
+            else if (operation == "ADD_PARTITION" || operation == "DROP_PARTITION") {
+                auto argument = std::string();
+                stream >> argument;
+                if (!table->partitioning || table->partitioning->kind != Partitioning::Kind::RANGE) {
+                    throw std::invalid_argument(fmt::format("Table '{}' is not partitioned by RANGE.", tableName));
+                }
+                if (argument.empty()) {
+                    throw std::invalid_argument(fmt::format("Partition bound or name must be provided for '{}'.", operation));
+                }
+
+                if (operation == "ADD_PARTITION") {
+                    auto const& key = *Utils::getColumn(*table, table->partitioning->column);
+                    if (key.type == ColumnType::NUMBER && !Utils::isNumber(argument)) {
+                        throw std::invalid_argument(fmt::format("Value '{}' is not a valid number for column '{}'.", argument, key.name));
+                    }
+                    auto const partitionName = database.addPartition(tableName, argument);
+                    fmt::println("Partition '{}' added to table '{}'.", partitionName, tableName);
+                } else {
+                    if (std::ranges::find(table->partitioning->partitions, argument, &Partition::name) == table->partitioning->partitions.end()) {
+                        throw std::invalid_argument(fmt::format("Partition '{}' does not exist in table '{}'.", argument, tableName));
+                    }
+                    database.dropPartition(tableName, argument);
+                    fmt::println("Partition '{}' dropped from table '{}'.", argument, tableName);
+                }
+            }
             else {
                 throw std::invalid_argument(fmt::format("Operation '{}' for command '{}' does not exist.", operation, command));
             }
@@ -472,28 +2200,95 @@ namespace Db {
         }
         else if (command == "WRITE_DATABASE") {
             auto filename = std::string();
-            stream >> filename;
-            auto file = std::fstream(filename, std::ios::out | std::ios::trunc);
+            auto mode = std::string();
+            stream >> filename >> mode;
+            std::ranges::transform(mode.begin(), mode.end(), mode.begin(), toupper);
+            if (!mode.empty() && mode != "BACKGROUND") {
+                throw std::invalid_argument(fmt::format("Write mode '{}' does not exist.", mode));
+            }
 
-            if (!file) {
-                throw std::runtime_error(fmt::format("Cannot open file '{}' for writing.", filename));
+            // pages of the opened database point into the backing file, they have to be reopened after it is replaced
+            auto const backing = !database.pool.file.empty() && std::filesystem::exists(filename) &&
+                std::filesystem::equivalent(filename, database.pool.file);
+
+            if (std::filesystem::is_directory(filename) || filename.ends_with('/')) {
+                if (mode == "BACKGROUND") {
+                    throw std::invalid_argument(fmt::format("Directory '{}' cannot be written in background.", filename));
+                }
+                database.waitForSnapshot();
+                database.saveToDirectory(filename);
+                fmt::println("Database saved to directory '{}'.", filename);
+            } else if (mode == "BACKGROUND") {
+                if (backing) {
+                    throw std::invalid_argument(fmt::format("File '{}' is opened as the database and cannot be written in background.", filename));
+                }
+                database.saveInBackground(filename);
+                fmt::println("Database snapshot to file '{}' started.", filename);
             } else {
-                database.writeToFile(file);
+                database.waitForSnapshot();
+                database.saveToFile(filename);
+                if (backing) {
+                    std::filesystem::remove(filename + ".catalog");
+                    database.openFromFile(filename, database.pool.capacity);
+                }
                 fmt::println("Database saved to file '{}'.", filename);
             }
         }
+        else if (command == "SNAPSHOT_STATUS") {
+            auto const snapshot = database.snapshot;
+            if (!snapshot) {
+                throw std::invalid_argument("No snapshot has been started.");
+            }
+
+            auto const state = snapshot->state.load();
+            if (state == Snapshot::State::RUNNING) {
+                auto const written = snapshot->written.load(std::memory_order_relaxed);
+                auto const percent = snapshot->total == 0 ? 100 : written * 100 / snapshot->total;
+                fmt::println("Snapshot to file '{}' is running, '{}' of '{}' values written ({}%).", snapshot->filename, written, snapshot->total, percent);
+            } else if (state == Snapshot::State::FINISHED) {
+                fmt::println("Snapshot to file '{}' finished, '{}' values written.", snapshot->filename, snapshot->total);
+            } else {
+                fmt::println("Snapshot to file '{}' failed: {}", snapshot->filename, snapshot->error);
+            }
+        }
         else if (command == "READ_DATABASE") {
             auto filename = std::string();
             stream >> filename;
             auto file = std::fstream(filename, std::ios::in);
 
-            if (!file) {
+            if (std::filesystem::is_directory(filename)) {
+                database.waitForSnapshot();
+                database.openFromDirectory(filename, 0);
+                for (auto& table : database.tables) {
+                    database.fetch(table);
+                }
+                fmt::println("Database loaded from directory '{}'.", filename);
+            } else if (!file) {
                 throw std::runtime_error(fmt::format("Cannot open file '{}' for reading.", filename));
             } else {
+                database.waitForSnapshot();
                 database.readFromFile(file);
                 fmt::println("Database loaded from file '{}'.", filename);
             }
         }
+        else if (command == "OPEN_DATABASE") {
+            auto filename = std::string();
+            auto capacity = std::string();
+            stream >> filename >> capacity;
+            if (!capacity.empty() && capacity.find_first_not_of("0123456789") != std::string::npos) {
+                throw std::invalid_argument(fmt::format("Buffer pool size '{}' is not a valid number.", capacity));
+            }
+
+            database.waitForSnapshot();
+            auto const size = capacity.empty() ? 256 * 1024 * 1024 : std::stoull(capacity);
+            if (std::filesystem::is_directory(filename)) {
+                database.openFromDirectory(filename, size);
+                fmt::println("Database opened from directory '{}'.", filename);
+            } else {
+                database.openFromFile(filename, size);
+                fmt::println("Database opened from file '{}'.", filename);
+            }
+        }
         else if (command == "TABLES_NAMES") {
             auto names = Utils::getNamesOfTables(database);
             if(names.empty()) {
@@ -514,6 +2309,27 @@ namespace Db {
             }
             fmt::println("Table '{}' has '{}' columns.", tableName, names);
         }
+        else if (command == "PARTITIONS_NAMES") {
+            auto tableName = std::string();
+            stream >> tableName;
+            if (!Utils::tableExists(database, tableName)) {
+                throw std::invalid_argument(fmt::format("Table '{}' does not exist in database.", tableName));
+            }
+            auto const& table = *Utils::getTable(database, tableName);
+            if (!table.partitioning) {
+                throw std::invalid_argument(fmt::format("Table '{}' is not partitioned.", tableName));
+            }
+
+            auto names = std::vector<std::string>();
+            for (auto const& partition : table.partitioning->partitions) {
+                if (table.partitioning->kind == Partitioning::Kind::HASH) {
+                    names.push_back(partition.name);
+                } else {
+                    names.push_back(fmt::format("{}[{}, {})", partition.name, partition.lower.value_or(""), partition.upper.value_or("")));
+                }
+            }
+            fmt::println("Table '{}' has '{}' partitions '{}'.", tableName, names.size(), fmt::join(names, " "));
+        }
         else if (command == "TABLES_COUNT") {
             auto count = Utils::getNumberOfTables(database);
             fmt::println("Database '{}' has '{}' tables.", database.name, count);
@@ -528,6 +2344,42 @@ namespace Db {
             auto count = Utils::getNumberOfColumns(*table);
             fmt::println("Table '{}' has '{}' columns.", tableName, count);
         }
+        else if (command == "ANALYZE") {
+            auto tableName = std::string();
+            stream >> tableName;
+            if (!Utils::tableExists(database, tableName)) {
+                throw std::invalid_argument(fmt::format("Table '{}' does not exist in database.", tableName));
+            }
+
+            database.analyze(tableName);
+            for (auto const& column : Utils::getTable(database, tableName)->columns) {
+                auto const& statistics = *column.statistics;
+                fmt::println("Column '{}' has '{}' rows, '{}' distinct values and '{}' nulls.", column.name, statistics.rows, statistics.distinct, statistics.nulls);
+            }
+            fmt::println("Table '{}' analyzed.", tableName);
+        }
+        else if (command == "SET") {
+            auto setting = std::string();
+            auto value = std::string();
+            stream >> setting >> value;
+            std::ranges::transform(value.begin(), value.end(), value.begin(), toupper);
+
+            if (setting == "result_cache") {
+                if (value != "ON" && value != "OFF") {
+                    throw std::invalid_argument(fmt::format("Value '{}' is not valid for setting '{}', use ON or OFF.", value, setting));
+                }
+                database.settings.resultCache = value == "ON";
+                database.results.clear();
+            } else if (setting == "memory_limit") {
+                if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos) {
+                    throw std::invalid_argument(fmt::format("Value '{}' is not valid for setting '{}', use a number of bytes.", value, setting));
+                }
+                database.settings.memoryLimit = std::stoull(value);
+            } else {
+                throw std::invalid_argument(fmt::format("Setting '{}' does not exist.", setting));
+            }
+            fmt::println("Setting '{}' set to '{}'.", setting, value);
+        }
         else if (command == "RENAME_DATABASE") {
             auto oldName = database.name;
             stream >> database.name;
@@ -538,36 +2390,22 @@ namespace Db {
         }
     }
 
-    auto Parser::parseWhereQuery(std::stringstream& stream, Table& table, std::vector<int>& rows) -> void {
+    auto Parser::readCondition(std::stringstream& stream) -> Condition {
         auto columnName = std::string();
         auto condition = std::string();
         auto value = std::string();
         auto opera = std::string();
 
-        auto columns = std::vector<std::string>();
-        auto conditions = std::vector<std::string>();
-        auto values = std::vector<std::string>();
-        auto operas = std::vector<std::string>();
-
+        auto result = Condition();
         while(stream >> columnName >> condition >> value) {
-            if(!Utils::columnExists(table, columnName)) {
-                throw std::invalid_argument(fmt::format("Column '{}' does not exist in table '{}'.", columnName, table.name));
-            }
-            if(!(condition == ">" || condition == ">=" || condition == "<" || condition == "<=" || condition == "==" || condition == "!=")) {
-                throw std::invalid_argument(fmt::format("Operator '{}' is not valid.", opera));
-            }
-            auto column = *Utils::getColumn(table, columnName);
-            if(column.type == ColumnType::NUMBER) {
-                try {
-                    std::stod(value);
-                } catch(...) {
-                    throw std::invalid_argument(fmt::format("Value '{}' is not a valid number for column '{}'.", value, columnName));
-                }
+            std::ranges::transform(condition.begin(), condition.end(), condition.begin(), toupper);
+            if(!(condition == ">" || condition == ">=" || condition == "<" || condition == "<=" || condition == "==" || condition == "!=" || condition == "LIKE")) {
+                throw std::invalid_argument(fmt::format("Operator '{}' is not valid.", condition));
             }
 
-            columns.push_back(columnName);
-            conditions.push_back(condition);
-            values.push_back(value);
+            result.columns.push_back(columnName);
+            result.conditions.push_back(condition);
+            result.values.push_back(value);
 
             if(!(stream >> opera)) {
                 break;
@@ -575,91 +2413,179 @@ namespace Db {
 
             std::ranges::transform(opera.begin(), opera.end(), opera.begin(), toupper);
             if(opera == "AND" || opera == "OR") {
-                operas.push_back(opera);
+                result.operas.push_back(opera);
             } else {
                 stream.seekg(-(static_cast<int>(opera.length()) + 1), std::ios::cur);
                 break;
             }
         }
 
-        auto newRows = std::vector<int>();
-        for(auto row : rows) {
-            auto include = Utils::evaluateCondition(table, columns[0], conditions[0], values[0], row);
-
-            for(auto i = 0; i < operas.size(); ++i) {
-                auto nextCondition = Utils::evaluateCondition(table, columns[i + 1], conditions[i + 1], values[i + 1], row);
-
-                if(operas[i] == "AND") {
-                    include = include && nextCondition;
-                } else {
-                    include = include || nextCondition;
-                }
-            }
-
-            if(include) {
-                newRows.push_back(row);
-            }
+        if(result.columns.empty() || result.operas.size() >= result.columns.size()) {
+            throw std::invalid_argument("Condition in WHERE clause is incomplete.");
         }
-        rows = newRows;
+        return result;
     }
-    auto Parser::parseOrderByQuery(std::stringstream& stream, Table& table, std::vector<int>& rows) -> void {
+    auto Parser::readOrdering(std::stringstream& stream) -> Ordering {
         auto columnName = std::string();
         auto order = std::string();
 
-        auto columns = std::vector<std::string>();
-        auto orders = std::vector<std::string>();
-
+        auto result = Ordering();
         while(stream >> columnName >> order) {
             std::ranges::transform(order.begin(), order.end(), order.begin(), toupper);
-            if(!Utils::columnExists(table, columnName)) {
-                throw std::invalid_argument(fmt::format("Column '{}' does not exist in table '{}'.", columnName, table.name));
-            }
             if(order == "ASC" || order == "DESC") {
-                columns.push_back(columnName);
-                orders.push_back(order);
+                result.columns.push_back(columnName);
+                result.orders.push_back(order);
             } else {
                 throw std::invalid_argument(fmt::format("Order '{}' is invalid.", order));
             }
         }
-
-        std::ranges::sort(rows.begin(), rows.end(), [&table, &columns, &orders](const int indexA, const int indexB) -> bool {
-            for(auto i = 0; i < columns.size(); ++i) {
-                const auto column = Utils::getColumn(table, columns[i]);
-                auto order = true;
-                if(orders[i] == "DESC") {
-                    order = false;
-                }
-
-                auto valueA = column->data[indexA];
-                auto valueB = column->data[indexB];
-
-               if(valueA != valueB) {
-                   if (column->type == ColumnType::NUMBER) {
-                       double numberA = std::stod(valueA);
-                       double numberB = std::stod(valueB);
-                       return order ? numberA < numberB : numberA > numberB;
-                   } else {
-                       return order ? valueA < valueB : valueA > valueB;
-                   }
-               }
-            }
-            return false;
-        });
+        return result;
     }
-    auto Parser::parseSelectQuery(std::stringstream& stream) -> void {
-        auto columns = std::vector<std::string>();
+    auto Parser::readSelectQuery(std::stringstream& stream) -> Query {
+        auto query = Query();
         auto column = std::string();
         while(stream >> column && column != "FROM" && column != "from") {
-            columns.push_back(column);
+            query.columns.push_back(column);
+        }
+        stream >> query.table;
+
+        auto operation = std::string();
+        auto streamPosition = stream.tellg();
+
+        stream >> operation;
+        if(operation == "WHERE" || operation == "where") {
+            query.where = readCondition(stream);
+        } else {
+            stream.seekg(streamPosition);
+        }
+
+        streamPosition = stream.tellg();
+        stream >> operation;
+        if(operation == "ORDER_BY" || operation == "order_by") {
+            query.orderBy = readOrdering(stream);
+        } else {
+            stream.seekg(streamPosition);
+        }
+        return query;
+    }
+    auto Parser::checkCondition(Table& table, Condition const& condition) -> void {
+        // columns are fetched and numbers parsed here, so filtering itself only reads the table
+        for(auto i = std::size_t(0); i < condition.columns.size(); ++i) {
+            if(!Utils::columnExists(table, condition.columns[i])) {
+                throw std::invalid_argument(fmt::format("Column '{}' does not exist in table '{}'.", condition.columns[i], table.name));
+            }
+            auto const& column = database.fetch(table, condition.columns[i]);
+            if(column.type == ColumnType::NUMBER && condition.conditions[i] == "LIKE") {
+                throw std::invalid_argument(fmt::format("Operator 'LIKE' is not valid for NUMBER column '{}'.", condition.columns[i]));
+            }
+            if(column.type == ColumnType::NUMBER) {
+                try {
+                    std::stod(condition.values[i]);
+                } catch(...) {
+                    throw std::invalid_argument(fmt::format("Value '{}' is not a valid number for column '{}'.", condition.values[i], condition.columns[i]));
+                }
+                column.data.numbers();
+            }
+        }
+    }
+    auto Parser::selectRows(Table& table, std::optional<Condition> const& condition, std::size_t firstRow) -> std::vector<std::pair<Table*, std::vector<int>>> {
+        if (condition) {
+            checkCondition(table, *condition);
+        }
+        auto targets = std::vector<Table*>();
+        if (table.partitioning) {
+            for (auto index : Utils::prunePartitions(table, condition)) {
+                targets.push_back(&*Utils::getTable(database, Utils::getPartitionTable(table, table.partitioning->partitions[index])));
+            }
+        } else {
+            targets.push_back(&table);
+        }
+
+        // the buffer pool is not thread safe, every column is fetched before the partitions are filtered in parallel
+        auto selected = std::vector<std::pair<Table*, std::vector<int>>>();
+        for (auto* target : targets) {
+            if (condition && target != &table) {
+                checkCondition(*target, *condition);
+            }
+            selected.emplace_back(target, Utils::getRows(*target, firstRow));
+        }
+        if (condition) {
+            Utils::parallelFor(selected.size(), [&selected, &condition](std::size_t i) -> void {
+                Utils::filterRows(*selected[i].first, *condition, selected[i].second);
+            });
+        }
+        return selected;
+    }
+    auto Parser::sortRows(Table& table, Ordering const& ordering, std::vector<int>& rows) -> void {
+        sortRows({&table}, {0}, ordering, rows);
+    }
+    auto Parser::sortRows(std::vector<Table*> const& tables, std::vector<std::size_t> const& offsets, Ordering const& ordering, std::vector<int>& rows) -> void {
+        // numbers are parsed before the runs are sorted, workers only read the columns
+        auto columns = std::vector<std::vector<Column const*>>(tables.size());
+        auto textBytes = std::vector<std::size_t>(ordering.columns.size());
+        auto textValues = std::vector<std::size_t>(ordering.columns.size());
+        for(auto t = std::size_t(0); t < tables.size(); ++t) {
+            for(auto i = std::size_t(0); i < ordering.columns.size(); ++i) {
+                if(!Utils::columnExists(*tables[t], ordering.columns[i])) {
+                    throw std::invalid_argument(fmt::format("Column '{}' does not exist in table '{}'.", ordering.columns[i], tables[t]->name));
+                }
+                auto const& column = database.fetch(*tables[t], ordering.columns[i]);
+                if(column.type == ColumnType::NUMBER) {
+                    column.data.numbers();
+                } else {
+                    textBytes[i] += Utils::estimateColumnBytes(column);
+                    textValues[i] += column.data.size();
+                }
+                columns[t].push_back(&column);
+            }
+        }
+
+        auto descending = std::vector<bool>();
+        auto rowBytes = sizeof(std::string) + 4;
+        for(auto i = std::size_t(0); i < ordering.columns.size(); ++i) {
+            descending.push_back(ordering.orders[i] == "DESC");
+            rowBytes += textValues[i] == 0 ? 8 : textBytes[i] / textValues[i] + 2;
+        }
+
+        Sort::sortRows(rows, [&columns, &descending, &offsets](std::string& key, int row) -> void {
+            auto const [table, local] = offsets.size() == 1 ? std::pair<std::size_t, int>(0, row) : Utils::locateRow(offsets, row);
+            for(auto i = std::size_t(0); i < descending.size(); ++i) {
+                auto const& column = *columns[table][i];
+                if(column.type == ColumnType::NUMBER) {
+                    Sort::appendNumber(key, column.data.numbers()[local], descending[i]);
+                } else {
+                    Sort::appendText(key, column.data[local], descending[i]);
+                }
+            }
+        }, rowBytes, database.settings.memoryLimit, std::filesystem::temp_directory_path().string());
+    }
+    auto Parser::parseSelectQuery(std::stringstream& stream) -> void {
+        auto const result = executeSelectQuery(stream);
+        if (result.partitions.empty()) {
+            Utils::printTable(*Utils::getTable(database, result.table), result.columns, result.rows);
+        } else {
+            auto table = Table{result.table, materialize(result)};
+            Utils::printTable(table, result.columns, Utils::getRows(table));
         }
+    }
+    auto Parser::executeSelectQuery(std::stringstream& stream, std::size_t firstRow) -> Result {
+        auto const key = firstRow == 0 && database.settings.resultCache
+            ? Utils::normalizeQuery(Utils::getRemainingQuery(stream))
+            : std::string();
 
-        auto tableName = std::string();
-        stream >> tableName;
+        return executeQuery(readSelectQuery(stream), firstRow, key);
+    }
+    auto Parser::executeQuery(Query const& query, std::size_t firstRow, std::string const& key) -> Result {
+        auto const& tableName = query.table;
         if (!Utils::tableExists(database, tableName)) {
             throw std::invalid_argument(fmt::format("Table '{}' does not exist.", tableName));
         }
         auto const& table = Utils::getTable(database, tableName);
+        if (table->view) {
+            refreshView(*table);
+        }
 
+        auto columns = query.columns;
         if(columns.size() == 1 && columns[0] == "*") {
             columns.clear();
             std::ranges::transform(table->columns.begin(),table->columns.end(), std::back_inserter(columns),
@@ -670,30 +2596,124 @@ namespace Db {
             if(!Utils::columnExists(*table, column)) {
                 throw std::invalid_argument(fmt::format("Column '{}' does not exist in table '{}'.", column, tableName));
             }
+            database.fetch(*table, column);
         }
 
-        auto firstIndex = 0;
-        auto rows = std::vector<int>(table->columns[0].data.size());
-        std::ranges::generate(rows.begin(), rows.end(), [&firstIndex]() -> int { return firstIndex++; });
+        if (!key.empty()) {
+            auto const cached = database.results.find(key);
+            if (cached != database.results.end() && cached->second.version == table->version) {
+                return cached->second;
+            }
+        }
 
-        auto operation = std::string();
-        auto streamPosition = stream.tellg();
+        auto result = Result{tableName, columns, {}, table->version};
+        auto const selected = selectRows(*table, query.where, firstRow);
+        if (!table->partitioning) {
+            result.rows = selected[0].second;
+            if(query.orderBy) {
+                sortRows(*table, *query.orderBy, result.rows);
+            }
+        } else {
+            auto partitions = std::vector<Table*>();
+            auto offset = std::size_t(0);
+            for (auto const& [partition, rows] : selected) {
+                partitions.push_back(partition);
+                result.partitions.push_back(partition->name);
+                result.offsets.push_back(offset);
+                for (auto row : rows) {
+                    result.rows.push_back(static_cast<int>(offset + row));
+                }
+                offset += Utils::getNumberOfRows(*partition);
+            }
+            if(query.orderBy) {
+                for (auto const& column : query.orderBy->columns) {
+                    if(!Utils::columnExists(*table, column)) {
+                        throw std::invalid_argument(fmt::format("Column '{}' does not exist in table '{}'.", column, tableName));
+                    }
+                }
+                sortRows(partitions, result.offsets, *query.orderBy, result.rows);
+            }
+        }
 
-        stream >> operation;
-        if(operation == "WHERE" || operation == "where") {
-            parseWhereQuery(stream, *table, rows);
+        if (!key.empty()) {
+            if (database.results.size() >= 64) {
+                database.results.clear();
+            }
+            database.results[key] = result;
+        }
+        return result;
+    }
+    auto Parser::refreshView(Table& view) -> void {
+        if (!Utils::tableExists(database, view.view->source)) {
+            throw std::invalid_argument(fmt::format("Source table '{}' of view '{}' does not exist.", view.view->source, view.name));
+        }
+        auto& source = *Utils::getTable(database, view.view->source);
+        // a view over a view only sees the changes of the underlying table once its source is refreshed
+        if (source.view) {
+            refreshView(source);
+        }
+        if (source.version == view.view->version) {
+            return;
+        }
+
+        // only inserts happened since the last refresh, the old rows keep their place unless the view is sorted
+        // rows of a partitioned table are renumbered whenever a partition grows, so its views are always rebuilt
+        auto const append = source.rewriteVersion == view.view->rewriteVersion && !view.view->ordered && !source.partitioning;
+        auto stream = std::stringstream(view.view->query);
+        auto const result = executeSelectQuery(stream, append ? view.view->rows : 0);
+        auto const columns = materialize(result);
+
+        if (!append) {
+            // the schema of the source may have changed, SELECT * views take the columns of the result
+            view.columns = columns;
+            for (auto& column : view.columns) {
+                column.lastUsed = ++database.pool.tick;
+            }
+            database.evict();
         } else {
-            stream.seekg(streamPosition);
+            database.fetch(view);
+            for (auto i = std::size_t(0); i < view.columns.size(); ++i) {
+                auto& column = view.columns[i];
+                column.data.reserve(column.data.size() + result.rows.size());
+                for (auto const& value : columns[i].data) {
+                    column.data.push_back(value);
+                }
+                column.page.reset();
+                column.dirty = true;
+            }
         }
 
-        streamPosition = stream.tellg();
-        stream >> operation;
-        if(operation == "ORDER_BY" || operation == "order_by") {
-            parseOrderByQuery(stream, *table, rows);
+        view.view->version = source.version;
+        view.view->rewriteVersion = source.rewriteVersion;
+        view.view->rows = Utils::getNumberOfRows(source);
+        database.touch(view, append);
+    }
+    auto Parser::materialize(Result const& result) -> std::vector<Column> {
+        auto& table = *Utils::getTable(database, result.table);
+        auto sources = std::vector<Table*>();
+        if (result.partitions.empty()) {
+            sources.push_back(&table);
         } else {
-            stream.seekg(streamPosition);
+            for (auto const& partition : result.partitions) {
+                sources.push_back(&*Utils::getTable(database, partition));
+            }
         }
 
-        Utils::printTable(*table, columns, rows);
+        auto columns = std::vector<Column>();
+        for (auto const& columnName : result.columns) {
+            auto values = std::vector<Values const*>();
+            for (auto* source : sources) {
+                values.push_back(&database.fetch(*source, columnName).data);
+            }
+
+            auto data = std::vector<std::string>();
+            data.reserve(result.rows.size());
+            for (auto row : result.rows) {
+                auto const [source, local] = result.partitions.empty() ? std::pair<std::size_t, int>(0, row) : Utils::locateRow(result.offsets, row);
+                data.push_back(std::as_const(*values[source])[local]);
+            }
+            columns.push_back({columnName, Utils::getColumn(table, columnName)->type, data});
+        }
+        return columns;
     }
 }
\ No newline at end of file
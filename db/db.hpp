@@ -1,26 +1,160 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
 #include <vector>
 #include <string>
 
+#include "filter.hpp"
+
 namespace Db {
     enum class ColumnType {
         TEXT=0, NUMBER=1
     };
+    // column values shared copy-on-write, so a snapshot of the database costs one pointer copy per column
+    struct Values {
+        Values() = default;
+        Values(std::vector<std::string> values);
+
+        auto size() const -> std::size_t;
+        auto empty() const -> bool;
+        auto capacity() const -> std::size_t;
+        auto operator[](std::size_t index) const -> std::string const&;
+        auto begin() const -> std::vector<std::string>::const_iterator;
+        auto end() const -> std::vector<std::string>::const_iterator;
+        auto data() const -> std::string const*;
+        auto numbers() const -> std::vector<double> const&;
+        auto parsedSize() const -> std::size_t;
+
+        auto operator[](std::size_t index) -> std::string&;
+        auto begin() -> std::vector<std::string>::iterator;
+        auto end() -> std::vector<std::string>::iterator;
+        auto push_back(std::string const& value) -> void;
+        auto erase(std::vector<std::string>::iterator position) -> std::vector<std::string>::iterator;
+        auto reserve(std::size_t size) -> void;
+        auto clear() -> void;
+        auto shrink_to_fit() -> void;
+
+    private:
+        std::shared_ptr<std::vector<std::string>> values = std::make_shared<std::vector<std::string>>();
+        mutable std::shared_ptr<std::vector<double>> parsed = nullptr;
+
+        auto detach() -> std::vector<std::string>&;
+    };
+
+    struct Page {
+        std::string path;
+        std::streamoff offset = 0;
+        std::size_t rows = 0;
+    };
+
+    // empty values count as nulls, bounds are the upper values of equi-depth histogram buckets
+    struct Statistics {
+        std::size_t rows = 0;
+        std::size_t nulls = 0;
+        std::size_t distinct = 0;
+        std::vector<std::string> bounds = {};
+    };
+
     struct Column {
         std::string name;
         ColumnType type;
-        std::vector<std::string> data = {};
+        Values data = {};
+        std::optional<Page> page = std::nullopt;
+        bool resident = true;
+        std::size_t lastUsed = 0;
+        bool dirty = true;
+        std::string segment;
+        std::optional<Statistics> statistics = std::nullopt;
+        // Bloom::CHUNK_WORDS words per chunk of Bloom::CHUNK_ROWS rows, shared copy-on-write like the values; a saved
+        // filter is read from its page together with the values, the rows of the page count chunks
+        std::shared_ptr<std::vector<std::uint64_t>> bloom = nullptr;
+        std::optional<Page> bloomPage = std::nullopt;
+    };
+
+    struct View {
+        std::string source;
+        std::string query;
+        std::size_t version = 0;
+        std::size_t rewriteVersion = 0;
+        std::size_t rows = 0;
+        bool ordered = false;
+    };
+
+    // RANGE partitions hold keys in [lower, upper), a missing bound is unbounded; rows of a partition live in the
+    // table named table#partition
+    struct Partition {
+        std::string name;
+        std::optional<std::string> lower = std::nullopt;
+        std::optional<std::string> upper = std::nullopt;
+    };
+
+    struct Partitioning {
+        enum class Kind {
+            RANGE=0, HASH=1
+        };
+
+        Kind kind = Kind::RANGE;
+        std::string column;
+        std::vector<Partition> partitions = {};
+        std::size_t next = 0;
     };
 
     struct Table {
         std::string name;
         std::vector<Column> columns = {};
+        bool dirty = true;
+        std::size_t version = 0;
+        std::size_t rewriteVersion = 0;
+        std::optional<View> view = std::nullopt;
+        std::optional<Partitioning> partitioning = std::nullopt;
     };
 
+    // rows of a partitioned table are numbered across its partitions, offsets[i] is the number of the first row of
+    // the table partitions[i]
+    struct Result {
+        std::string table;
+        std::vector<std::string> columns = {};
+        std::vector<int> rows = {};
+        std::size_t version = 0;
+        std::vector<std::string> partitions = {};
+        std::vector<std::size_t> offsets = {};
+    };
+
+    // memoryLimit bounds the sort keys of ORDER_BY in bytes, 0 means no limit
+    struct Settings {
+        bool resultCache = false;
+        std::size_t memoryLimit = 0;
+    };
+
+    struct BufferPool {
+        std::string file;
+        std::size_t capacity = 0;
+        std::size_t tick = 0;
+        std::size_t statement = 0;
+        std::size_t spills = 0;
+    };
+
+    struct Snapshot;
+
     struct Database {
         std::string name = "db1";
         std::vector<Table> tables = {};
+        BufferPool pool = {};
+        std::shared_ptr<Snapshot> snapshot = nullptr;
+        std::string directory;
+        std::size_t generation = 0;
+        std::size_t version = 0;
+        Settings settings = {};
+        std::map<std::string, Result> results = {};
 
         Database() = default;
         Database(const Database& other) = default;
@@ -36,20 +170,85 @@ namespace Db {
         auto removeColumn(std::string const& tableName, std::string const& columnName) -> void;
 
         auto insertRow(std::string const& tableName, std::vector<std::string> const& row) -> void;
-        auto updateRow(std::string const& tableName, std::string const& columnName, std::string const& newValue, std::string const& conditionColumnName, std::string const& condition, std::string const& conditionValue) -> void;
-        auto removeRow(std::string const& tableName, std::string const& conditionColumnName, std::string const& condition, std::string const& conditionValue) -> void;
+        auto insertRows(std::string const& tableName, std::vector<std::vector<std::string>> const& columns) -> void;
+        auto updateRow(std::string const& tableName, std::vector<std::string> const& columnNames, std::vector<std::string> const& newValues, std::vector<int> const& rows) -> void;
+        auto removeRow(std::string const& tableName, std::vector<int> const& rows) -> void;
+        auto touch(Table& table, bool append) -> void;
+        auto analyze(std::string const& tableName) -> void;
+        auto partitionTable(std::string const& tableName, Partitioning const& partitioning) -> void;
+        auto addPartition(std::string const& tableName, std::string const& bound) -> std::string;
+        auto dropPartition(std::string const& tableName, std::string const& partitionName) -> void;
+        auto addBloomFilter(std::string const& tableName, std::string const& columnName) -> void;
+        auto dropBloomFilter(std::string const& tableName, std::string const& columnName) -> void;
 
-        auto writeToFile(std::fstream& file) const -> void;
+        auto writeToFile(std::fstream& file, std::atomic<std::size_t>* written = nullptr) const -> void;
+        auto saveToFile(std::string const& filename, std::atomic<std::size_t>* written = nullptr) const -> void;
+        auto saveInBackground(std::string const& filename) -> void;
+        auto waitForSnapshot() -> void;
         auto readFromFile(std::fstream& file) -> void;
+        auto openFromFile(std::string const& filename, std::size_t capacity) -> void;
+        auto saveToDirectory(std::string const& path) -> void;
+        auto openFromDirectory(std::string const& path, std::size_t capacity) -> void;
+
+        auto fetch(Table& table) -> void;
+        auto fetch(Table& table, std::string const& columnName) -> Column&;
+        auto evict() -> void;
+        auto resetPool() -> void;
+    };
+
+    struct Snapshot {
+        enum class State {
+            RUNNING=0, FINISHED=1, FAILED=2
+        };
+
+        std::string filename;
+        Database database;
+        std::size_t total = 0;
+        std::atomic<std::size_t> written = 0;
+        std::atomic<State> state = State::RUNNING;
+        std::string error;
+        std::thread worker;
+
+        ~Snapshot();
+    };
+
+    // WHERE clauses in query order, operas[i] joins clause i and i + 1
+    struct Condition {
+        std::vector<std::string> columns = {};
+        std::vector<std::string> conditions = {};
+        std::vector<std::string> values = {};
+        std::vector<std::string> operas = {};
+    };
+
+    struct Ordering {
+        std::vector<std::string> columns = {};
+        std::vector<std::string> orders = {};
+    };
+
+    // SELECT parsed once, names are resolved against the table only when it is executed
+    struct Query {
+        std::string table;
+        std::vector<std::string> columns = {};
+        std::optional<Condition> where = std::nullopt;
+        std::optional<Ordering> orderBy = std::nullopt;
     };
 
     struct Parser {
         Database& database;
 
         auto parseQuery(std::string const& query) -> void;
-        auto parseWhereQuery(std::stringstream& stream, Table& table, std::vector<int>& rows) -> void;
-        auto parseOrderByQuery(std::stringstream& stream, Table& table, std::vector<int>& rows) -> void;
         auto parseSelectQuery(std::stringstream& stream) -> void;
+        auto readCondition(std::stringstream& stream) -> Condition;
+        auto readOrdering(std::stringstream& stream) -> Ordering;
+        auto readSelectQuery(std::stringstream& stream) -> Query;
+        auto checkCondition(Table& table, Condition const& condition) -> void;
+        auto selectRows(Table& table, std::optional<Condition> const& condition, std::size_t firstRow = 0) -> std::vector<std::pair<Table*, std::vector<int>>>;
+        auto sortRows(Table& table, Ordering const& ordering, std::vector<int>& rows) -> void;
+        auto sortRows(std::vector<Table*> const& tables, std::vector<std::size_t> const& offsets, Ordering const& ordering, std::vector<int>& rows) -> void;
+        auto executeSelectQuery(std::stringstream& stream, std::size_t firstRow = 0) -> Result;
+        auto executeQuery(Query const& query, std::size_t firstRow = 0, std::string const& key = "") -> Result;
+        auto refreshView(Table& view) -> void;
+        auto materialize(Result const& result) -> std::vector<Column>;
     };
 
     namespace Utils {
@@ -62,11 +261,42 @@ namespace Db {
         auto uniqueValue(Column const& column, std::string const& value) -> bool;
         auto getNumberOfTables(Database const& database) -> int;
         auto getNumberOfColumns(Table const& table) -> int;
+        auto getNumberOfRows(Table const& table) -> std::size_t;
+        auto getNumberOfValues(Column const& column) -> std::size_t;
+        auto getRows(Table const& table, std::size_t firstRow = 0) -> std::vector<int>;
+        auto estimateColumnBytes(Column const& column) -> std::size_t;
         auto getNamesOfTables(Database const& database) -> std::string;
         auto getNamesOfColumns(Table const& table) -> std::string;
         auto printTable(Table const& table, std::vector<std::string> columns, std::vector<int> rows) -> void;
-        auto evaluateCondition(Table& table, const std::string& columnName, const std::string& condition, const std::string& value, int row) -> bool;
         auto isNumber(const std::string& str) -> bool;
         auto checkColumnType(const Column& column, const std::string& value) -> void;
+        auto writeValues(std::fstream& file, Column const& column) -> void;
+        auto syncFile(std::string const& path) -> void;
+        auto getRemainingQuery(std::stringstream& stream) -> std::string;
+        auto normalizeQuery(std::string const& query) -> std::string;
+        auto updateStatistics(Column& column, std::string const& value) -> void;
+        auto estimateSelectivity(Column const& column, Filter::Operator op, std::string const& value) -> double;
+        auto filterRows(Table& table, Condition const& condition, std::vector<int>& rows) -> void;
+        auto parallelFor(std::size_t count, std::function<void(std::size_t)> const& work) -> void;
+        auto lessThan(ColumnType type, std::string const& a, std::string const& b) -> bool;
+        auto hashValue(ColumnType type, std::string const& value) -> std::uint64_t;
+        auto getPartitionTable(Table const& table, Partition const& partition) -> std::string;
+        auto isPartition(Database const& database, std::string const& name) -> bool;
+        auto findPartition(Table const& table, std::string const& value) -> std::optional<std::size_t>;
+        auto prunePartitions(Table const& table, std::optional<Condition> const& condition) -> std::vector<std::size_t>;
+        auto locateRow(std::vector<std::size_t> const& offsets, int row) -> std::pair<std::size_t, int>;
+        auto writePartitioning(std::ostream& file, std::vector<Table> const& tables) -> void;
+        auto readPartitioning(std::istream& file, std::vector<Table>& tables) -> void;
+        auto getBloomHash(ColumnType type, std::string const& value) -> std::uint64_t;
+        auto buildBloom(Column& column) -> void;
+        auto addToBloom(Column& column, std::size_t row) -> void;
+        auto hasBloom(Column const& column) -> bool;
+        auto writeBloom(std::ostream& file, Column const& column) -> void;
+        auto getBloomChunks(Column const& column) -> std::size_t;
+        auto readBloom(std::istream& file, std::size_t chunks, std::string const& columnName) -> std::shared_ptr<std::vector<std::uint64_t>>;
+        auto writeBlooms(std::ostream& file, std::vector<Table> const& tables) -> void;
+        auto readBlooms(std::istream& file, std::vector<Table>& tables, std::string const& path = "") -> void;
+        auto writeBloomPages(std::ostream& file, std::vector<Table> const& tables) -> void;
+        auto readBloomPages(std::istream& file, std::vector<Table>& tables, std::string const& directory) -> void;
     }
 }
@@ -0,0 +1,385 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define DB_FILTER_X86 1
+#include <immintrin.h>
+#endif
+
+#include "filter.hpp"
+
+namespace Db::Filter {
+    namespace {
+        template<Operator op, typename T>
+        auto test(T const& value, T const& constant) -> bool {
+            if constexpr (op == Operator::GREATER) {
+                return value > constant;
+            } else if constexpr (op == Operator::GREATER_EQUAL) {
+                return value >= constant;
+            } else if constexpr (op == Operator::LESS) {
+                return value < constant;
+            } else if constexpr (op == Operator::LESS_EQUAL) {
+                return value <= constant;
+            } else if constexpr (op == Operator::EQUAL) {
+                return value == constant;
+            } else {
+                return value != constant;
+            }
+        }
+
+        template<typename T, typename Test>
+        auto scanScalar(T const* values, std::size_t count, Test const& test, std::uint64_t* mask) -> void {
+            for (auto word = std::size_t(0); word * 64 < count; ++word) {
+                auto const base = word * 64;
+                auto const end = std::min<std::size_t>(64, count - base);
+                auto bits = std::uint64_t(0);
+                for (auto i = std::size_t(0); i < end; ++i) {
+                    bits |= static_cast<std::uint64_t>(test(values[base + i])) << i;
+                }
+                mask[word] = bits;
+            }
+        }
+
+        template<typename T, typename Test>
+        auto scanActive(T const* values, std::size_t count, Test const& test, std::uint64_t* mask, std::uint64_t const* active) -> void {
+            for (auto word = std::size_t(0); word * 64 < count; ++word) {
+                auto const base = word * 64;
+                auto pending = active[word];
+                if (count - base < 64) {
+                    pending &= (std::uint64_t(1) << (count - base)) - 1;
+                }
+                auto bits = std::uint64_t(0);
+                while (pending != 0) {
+                    auto const i = std::countr_zero(pending);
+                    bits |= static_cast<std::uint64_t>(test(values[base + i])) << i;
+                    pending &= pending - 1;
+                }
+                mask[word] = bits;
+            }
+        }
+
+        template<Operator op, typename T>
+        auto compareScalar(T const* values, std::size_t count, T const& constant, std::uint64_t* mask) -> void {
+            scanScalar(values, count, [&constant](T const& value) { return test<op>(value, constant); }, mask);
+        }
+
+        template<Operator op, typename T>
+        auto compareActive(T const* values, std::size_t count, T const& constant, std::uint64_t* mask, std::uint64_t const* active) -> void {
+            scanActive(values, count, [&constant](T const& value) { return test<op>(value, constant); }, mask, active);
+        }
+
+        // patterns with '%' only at their ends compare one literal, anything else is matched with backtracking
+        struct Pattern {
+            enum class Kind {
+                EXACT=0, PREFIX=1, SUFFIX=2, CONTAINS=3, GENERAL=4
+            };
+
+            Kind kind = Kind::GENERAL;
+            std::string_view literal;
+        };
+
+        auto compile(std::string_view pattern) -> Pattern {
+            auto literal = pattern;
+            auto const leading = literal.starts_with('%');
+            auto const trailing = literal.ends_with('%');
+            while (literal.starts_with('%')) {
+                literal.remove_prefix(1);
+            }
+            while (literal.ends_with('%')) {
+                literal.remove_suffix(1);
+            }
+            if (literal.find_first_of("%_") != std::string_view::npos) {
+                return {Pattern::Kind::GENERAL, pattern};
+            }
+            if (leading && trailing) {
+                return {Pattern::Kind::CONTAINS, literal};
+            }
+            return {leading ? Pattern::Kind::SUFFIX : trailing ? Pattern::Kind::PREFIX : Pattern::Kind::EXACT, literal};
+        }
+
+        auto matchWildcards(std::string_view value, std::string_view pattern) -> bool {
+            // on a mismatch the last '%' takes one more character and matching resumes behind it
+            auto v = std::size_t(0);
+            auto p = std::size_t(0);
+            auto star = std::string_view::npos;
+            auto resume = std::size_t(0);
+            while (v < value.size()) {
+                if (p < pattern.size() && pattern[p] == '%') {
+                    star = p++;
+                    resume = v;
+                } else if (p < pattern.size() && (pattern[p] == '_' || pattern[p] == value[v])) {
+                    ++v;
+                    ++p;
+                } else if (star != std::string_view::npos) {
+                    p = star + 1;
+                    v = ++resume;
+                } else {
+                    return false;
+                }
+            }
+            while (p < pattern.size() && pattern[p] == '%') {
+                ++p;
+            }
+            return p == pattern.size();
+        }
+
+#ifdef DB_FILTER_X86
+        // blocks are searched for the first and the last character of the needle at once, only positions where both
+        // match are compared in full
+        __attribute__((target("avx2")))
+        auto containsAvx2(char const* text, std::size_t size, std::string_view needle) -> std::size_t {
+            auto const first = _mm256_set1_epi8(needle.front());
+            auto const last = _mm256_set1_epi8(needle.back());
+            auto i = std::size_t(0);
+            for (; i + needle.size() - 1 + 32 <= size; i += 32) {
+                auto const firstBlock = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(text + i));
+                auto const lastBlock = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(text + i + needle.size() - 1));
+                auto candidates = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+                    _mm256_and_si256(_mm256_cmpeq_epi8(firstBlock, first), _mm256_cmpeq_epi8(lastBlock, last))));
+                while (candidates != 0) {
+                    auto const position = i + std::countr_zero(candidates);
+                    if (std::memcmp(text + position + 1, needle.data() + 1, needle.size() - 2) == 0) {
+                        return std::string_view::npos;
+                    }
+                    candidates &= candidates - 1;
+                }
+            }
+            return i;
+        }
+
+        auto containsSse2(char const* text, std::size_t size, std::string_view needle) -> std::size_t {
+            auto const first = _mm_set1_epi8(needle.front());
+            auto const last = _mm_set1_epi8(needle.back());
+            auto i = std::size_t(0);
+            for (; i + needle.size() - 1 + 16 <= size; i += 16) {
+                auto const firstBlock = _mm_loadu_si128(reinterpret_cast<__m128i const*>(text + i));
+                auto const lastBlock = _mm_loadu_si128(reinterpret_cast<__m128i const*>(text + i + needle.size() - 1));
+                auto candidates = static_cast<std::uint32_t>(_mm_movemask_epi8(
+                    _mm_and_si128(_mm_cmpeq_epi8(firstBlock, first), _mm_cmpeq_epi8(lastBlock, last))));
+                while (candidates != 0) {
+                    auto const position = i + std::countr_zero(candidates);
+                    if (std::memcmp(text + position + 1, needle.data() + 1, needle.size() - 2) == 0) {
+                        return std::string_view::npos;
+                    }
+                    candidates &= candidates - 1;
+                }
+            }
+            return i;
+        }
+#endif
+
+        auto contains(std::string_view value, std::string_view needle) -> bool {
+            if (needle.size() < 2) {
+                return needle.empty() || std::memchr(value.data(), needle.front(), value.size()) != nullptr;
+            }
+            // the kernels return npos on a match, otherwise the position from which the rest is searched scalar
+            auto start = std::size_t(0);
+#ifdef DB_FILTER_X86
+            static auto const avx2 = __builtin_cpu_supports("avx2");
+            start = avx2 ? containsAvx2(value.data(), value.size(), needle) : containsSse2(value.data(), value.size(), needle);
+            if (start == std::string_view::npos) {
+                return true;
+            }
+#endif
+            return value.substr(start).find(needle) != std::string_view::npos;
+        }
+
+        auto match(Pattern const& pattern, std::string_view value) -> bool {
+            auto const& literal = pattern.literal;
+            switch (pattern.kind) {
+                case Pattern::Kind::EXACT:
+                    return value == literal;
+                case Pattern::Kind::PREFIX:
+                    return value.size() >= literal.size() && std::memcmp(value.data(), literal.data(), literal.size()) == 0;
+                case Pattern::Kind::SUFFIX:
+                    return value.size() >= literal.size() && std::memcmp(value.data() + value.size() - literal.size(), literal.data(), literal.size()) == 0;
+                case Pattern::Kind::CONTAINS:
+                    return contains(value, literal);
+                case Pattern::Kind::GENERAL:
+                    return matchWildcards(value, literal);
+            }
+            return false;
+        }
+
+#ifdef DB_FILTER_X86
+        // ordered predicates are false for NaN (values that are not numbers), != is true for them like in scalar code
+        template<Operator op>
+        constexpr auto predicate() -> int {
+            if constexpr (op == Operator::GREATER) {
+                return _CMP_GT_OQ;
+            } else if constexpr (op == Operator::GREATER_EQUAL) {
+                return _CMP_GE_OQ;
+            } else if constexpr (op == Operator::LESS) {
+                return _CMP_LT_OQ;
+            } else if constexpr (op == Operator::LESS_EQUAL) {
+                return _CMP_LE_OQ;
+            } else if constexpr (op == Operator::EQUAL) {
+                return _CMP_EQ_OQ;
+            } else {
+                return _CMP_NEQ_UQ;
+            }
+        }
+
+        template<Operator op>
+        __attribute__((target("avx2")))
+        auto compareNumbersAvx2(double const* values, std::size_t count, double constant, std::uint64_t* mask) -> void {
+            // the predicate has to be an immediate, a constexpr local keeps it one in unoptimized builds too
+            constexpr auto comparison = predicate<op>();
+            auto const constants = _mm256_set1_pd(constant);
+            auto const full = count / 64;
+            for (auto word = std::size_t(0); word < full; ++word) {
+                auto bits = std::uint64_t(0);
+                for (auto i = 0; i < 64; i += 4) {
+                    auto const compared = _mm256_cmp_pd(_mm256_loadu_pd(values + word * 64 + i), constants, comparison);
+                    bits |= static_cast<std::uint64_t>(_mm256_movemask_pd(compared)) << i;
+                }
+                mask[word] = bits;
+            }
+            if (count % 64 != 0) {
+                compareScalar<op>(values + full * 64, count % 64, constant, mask + full);
+            }
+        }
+
+        template<Operator op>
+        auto compareNumbersSse2(double const* values, std::size_t count, double constant, std::uint64_t* mask) -> void {
+            auto const constants = _mm_set1_pd(constant);
+            auto const full = count / 64;
+            for (auto word = std::size_t(0); word < full; ++word) {
+                auto bits = std::uint64_t(0);
+                for (auto i = 0; i < 64; i += 2) {
+                    auto const loaded = _mm_loadu_pd(values + word * 64 + i);
+                    auto compared = __m128d();
+                    if constexpr (op == Operator::GREATER) {
+                        compared = _mm_cmpgt_pd(loaded, constants);
+                    } else if constexpr (op == Operator::GREATER_EQUAL) {
+                        compared = _mm_cmpge_pd(loaded, constants);
+                    } else if constexpr (op == Operator::LESS) {
+                        compared = _mm_cmplt_pd(loaded, constants);
+                    } else if constexpr (op == Operator::LESS_EQUAL) {
+                        compared = _mm_cmple_pd(loaded, constants);
+                    } else if constexpr (op == Operator::EQUAL) {
+                        compared = _mm_cmpeq_pd(loaded, constants);
+                    } else {
+                        compared = _mm_cmpneq_pd(loaded, constants);
+                    }
+                    bits |= static_cast<std::uint64_t>(_mm_movemask_pd(compared)) << i;
+                }
+                mask[word] = bits;
+            }
+            if (count % 64 != 0) {
+                compareScalar<op>(values + full * 64, count % 64, constant, mask + full);
+            }
+        }
+#endif
+
+        template<Operator op>
+        auto compareNumbersFor(double const* values, std::size_t count, double constant, std::uint64_t* mask) -> void {
+#ifdef DB_FILTER_X86
+            static auto const avx2 = __builtin_cpu_supports("avx2");
+            if (avx2) {
+                compareNumbersAvx2<op>(values, count, constant, mask);
+            } else {
+                compareNumbersSse2<op>(values, count, constant, mask);
+            }
+#else
+            compareScalar<op>(values, count, constant, mask);
+#endif
+        }
+
+        template<template<Operator> typename Kernel, typename... Arguments>
+        auto dispatch(Operator op, Arguments&&... arguments) -> void {
+            switch (op) {
+                case Operator::GREATER:
+                    return Kernel<Operator::GREATER>::run(arguments...);
+                case Operator::GREATER_EQUAL:
+                    return Kernel<Operator::GREATER_EQUAL>::run(arguments...);
+                case Operator::LESS:
+                    return Kernel<Operator::LESS>::run(arguments...);
+                case Operator::LESS_EQUAL:
+                    return Kernel<Operator::LESS_EQUAL>::run(arguments...);
+                case Operator::EQUAL:
+                    return Kernel<Operator::EQUAL>::run(arguments...);
+                case Operator::NOT_EQUAL:
+                    return Kernel<Operator::NOT_EQUAL>::run(arguments...);
+                case Operator::LIKE:
+                    // patterns are matched before dispatching, no kernel compares with LIKE
+                    break;
+            }
+        }
+
+        template<Operator op>
+        struct NumberKernel {
+            static auto run(double const* values, std::size_t count, double constant, std::uint64_t* mask) -> void {
+                compareNumbersFor<op>(values, count, constant, mask);
+            }
+        };
+
+        template<Operator op>
+        struct TextKernel {
+            static auto run(std::string const* values, std::size_t count, std::string const& constant, std::uint64_t* mask, std::uint64_t const* active) -> void {
+                if (active) {
+                    compareActive<op>(values, count, constant, mask, active);
+                } else {
+                    compareScalar<op>(values, count, constant, mask);
+                }
+            }
+        };
+    }
+
+    auto toOperator(std::string const& condition) -> Operator {
+        if (condition == ">") {
+            return Operator::GREATER;
+        }
+        if (condition == ">=") {
+            return Operator::GREATER_EQUAL;
+        }
+        if (condition == "<") {
+            return Operator::LESS;
+        }
+        if (condition == "<=") {
+            return Operator::LESS_EQUAL;
+        }
+        if (condition == "==") {
+            return Operator::EQUAL;
+        }
+        if (condition == "!=") {
+            return Operator::NOT_EQUAL;
+        }
+        if (condition == "LIKE") {
+            return Operator::LIKE;
+        }
+        throw std::invalid_argument("Operator '" + condition + "' is not valid.");
+    }
+
+    auto matchPattern(std::string_view value, std::string_view pattern) -> bool {
+        return match(compile(pattern), value);
+    }
+    auto getPatternPrefix(std::string const& pattern) -> std::string {
+        return pattern.substr(0, pattern.find_first_of("%_"));
+    }
+
+    auto compareNumbers(Operator op, double const* values, std::size_t count, double constant, std::uint64_t* mask) -> void {
+        if (op == Operator::LIKE) {
+            throw std::invalid_argument("Operator 'LIKE' is only valid for TEXT values.");
+        }
+        dispatch<NumberKernel>(op, values, count, constant, mask);
+    }
+    auto compareTexts(Operator op, std::string const* values, std::size_t count, std::string const& constant, std::uint64_t* mask, std::uint64_t const* active) -> void {
+        if (op == Operator::LIKE) {
+            // the pattern is compiled once per batch, substrings are searched with the SIMD kernels
+            auto const pattern = compile(constant);
+            auto const like = [&pattern](std::string const& value) -> bool {
+                return match(pattern, value);
+            };
+            if (active) {
+                scanActive(values, count, like, mask, active);
+            } else {
+                scanScalar(values, count, like, mask);
+            }
+            return;
+        }
+        dispatch<TextKernel>(op, values, count, constant, mask, active);
+    }
+}
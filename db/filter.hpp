@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Db::Filter {
+    enum class Operator {
+        GREATER=0, GREATER_EQUAL=1, LESS=2, LESS_EQUAL=3, EQUAL=4, NOT_EQUAL=5, LIKE=6
+    };
+
+    // rows are filtered in batches, a batch is described by one bit per row
+    constexpr auto BATCH_SIZE = std::size_t(2048);
+    constexpr auto BATCH_WORDS = BATCH_SIZE / 64;
+
+    auto toOperator(std::string const& condition) -> Operator;
+
+    // set bit i of mask when values[i] op constant holds, for i in [0, count)
+    auto compareNumbers(Operator op, double const* values, std::size_t count, double constant, std::uint64_t* mask) -> void;
+    // LIKE patterns match TEXT values, '%' stands for any sequence of characters and '_' for exactly one
+    auto matchPattern(std::string_view value, std::string_view pattern) -> bool;
+    // characters before the first wildcard, every matching value starts with them
+    auto getPatternPrefix(std::string const& pattern) -> std::string;
+    // string comparisons are expensive, only rows whose bit is set in active (when given) are compared
+    auto compareTexts(Operator op, std::string const* values, std::size_t count, std::string const& constant, std::uint64_t* mask, std::uint64_t const* active = nullptr) -> void;
+}
@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include <limits>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "sort.hpp"
+
+namespace Db::Sort {
+    namespace {
+        struct Run {
+            std::vector<std::string> keys = {};
+            std::string path;
+        };
+
+        // spilled runs are removed also when sorting fails half way
+        struct Runs {
+            std::vector<Run> runs = {};
+
+            ~Runs() {
+                for (auto const& run : runs) {
+                    if (!run.path.empty()) {
+                        auto error = std::error_code();
+                        std::filesystem::remove(run.path, error);
+                    }
+                }
+            }
+        };
+
+        struct Reader {
+            Run* run = nullptr;
+            std::size_t position = 0;
+            std::ifstream file;
+
+            auto next(std::string& key) -> bool {
+                if (run->path.empty()) {
+                    if (position == run->keys.size()) {
+                        return false;
+                    }
+                    key = std::move(run->keys[position++]);
+                    return true;
+                }
+                auto size = std::uint32_t(0);
+                if (!file.read(reinterpret_cast<char*>(&size), sizeof(size))) {
+                    return false;
+                }
+                key.resize(size);
+                if (!file.read(key.data(), size)) {
+                    throw std::runtime_error(fmt::format("Sort run '{}' is truncated.", run->path));
+                }
+                return true;
+            }
+        };
+
+        // one file stays open per merged run, more runs are first merged into fewer longer ones
+        constexpr auto MERGE_WIDTH = std::size_t(64);
+
+        auto writeKey(std::ofstream& file, std::string const& key) -> void {
+            auto const size = static_cast<std::uint32_t>(key.size());
+            file.write(reinterpret_cast<char const*>(&size), sizeof(size));
+            file.write(key.data(), size);
+        }
+
+        // k-way merge, the heap holds the smallest key not yet taken from every run
+        auto merge(std::vector<Run>& runs, std::size_t first, std::size_t last, std::function<void(std::string const& key)> const& output) -> void {
+            auto readers = std::vector<Reader>(last - first);
+            using Entry = std::pair<std::string, std::size_t>;
+            auto heap = std::priority_queue<Entry, std::vector<Entry>, std::greater<>>();
+            for (auto i = std::size_t(0); i < readers.size(); ++i) {
+                auto& run = runs[first + i];
+                readers[i].run = &run;
+                if (!run.path.empty()) {
+                    readers[i].file.open(run.path, std::ios::binary);
+                    if (!readers[i].file) {
+                        throw std::runtime_error(fmt::format("Cannot read sort run '{}'.", run.path));
+                    }
+                }
+                auto key = std::string();
+                if (readers[i].next(key)) {
+                    heap.emplace(std::move(key), i);
+                }
+            }
+
+            while (!heap.empty()) {
+                auto [key, reader] = heap.top();
+                heap.pop();
+                output(key);
+                if (readers[reader].next(key)) {
+                    heap.emplace(std::move(key), reader);
+                }
+            }
+        }
+
+        auto appendRow(std::string& key, int row) -> void {
+            auto const value = static_cast<std::uint32_t>(row);
+            for (auto shift = 24; shift >= 0; shift -= 8) {
+                key.push_back(static_cast<char>(value >> shift & 0xFF));
+            }
+        }
+
+        auto getRow(std::string const& key) -> int {
+            auto value = std::uint32_t(0);
+            for (auto i = key.size() - 4; i < key.size(); ++i) {
+                value = value << 8 | static_cast<unsigned char>(key[i]);
+            }
+            return static_cast<int>(value);
+        }
+
+        auto sortRun(std::vector<int> const& rows, std::size_t first, std::size_t last, Run& run,
+            std::function<void(std::string& key, int row)> const& encode) -> void {
+            run.keys.resize(last - first);
+            for (auto i = first; i < last; ++i) {
+                auto& key = run.keys[i - first];
+                encode(key, rows[i]);
+                // the row breaks ties, equal rows keep their order and every key is unique
+                appendRow(key, rows[i]);
+            }
+            std::ranges::sort(run.keys);
+
+            if (run.path.empty()) {
+                return;
+            }
+            auto file = std::ofstream(run.path, std::ios::binary | std::ios::trunc);
+            if (!file) {
+                throw std::runtime_error(fmt::format("Cannot write sort run '{}'.", run.path));
+            }
+            for (auto const& key : run.keys) {
+                writeKey(file, key);
+            }
+            if (!file.flush()) {
+                throw std::runtime_error(fmt::format("Cannot write sort run '{}'.", run.path));
+            }
+            run.keys.clear();
+            run.keys.shrink_to_fit();
+        }
+    }
+
+    auto appendNumber(std::string& key, double value, bool descending) -> void {
+        // values that are not numbers (empty values) sort as the largest number, last with ASC and first with DESC
+        if (std::isnan(value)) {
+            value = std::numeric_limits<double>::quiet_NaN();
+        }
+        // flipping the sign bit of positive numbers and every bit of negative ones orders them as unsigned integers
+        auto bits = std::bit_cast<std::uint64_t>(value == 0.0 ? 0.0 : value);
+        bits = (bits >> 63) != 0 ? ~bits : bits | std::uint64_t(1) << 63;
+        if (descending) {
+            bits = ~bits;
+        }
+        for (auto shift = 56; shift >= 0; shift -= 8) {
+            key.push_back(static_cast<char>(bits >> shift & 0xFF));
+        }
+    }
+    auto appendText(std::string& key, std::string const& value, bool descending) -> void {
+        // 0x00 is escaped as 0x00 0xFF and the value ends with 0x00 0x00, so a prefix sorts before longer values
+        auto const mask = static_cast<char>(descending ? 0xFF : 0x00);
+        for (auto character : value) {
+            key.push_back(static_cast<char>(character ^ mask));
+            if (character == '\0') {
+                key.push_back(static_cast<char>(0xFF ^ mask));
+            }
+        }
+        key.push_back(mask);
+        key.push_back(mask);
+    }
+
+    auto sortRows(std::vector<int>& rows, std::function<void(std::string& key, int row)> const& encode,
+        std::size_t rowBytes, std::size_t memoryLimit, std::string const& directory) -> void {
+        if (rows.size() < 2) {
+            return;
+        }
+
+        auto const threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+        auto runRows = std::max(MIN_RUN_ROWS, (rows.size() + threads - 1) / threads);
+        auto spill = false;
+        if (memoryLimit != 0) {
+            // the runs sorted at the same time share the budget, each run is spilled before the next ones start
+            runRows = std::min(runRows, std::max(MIN_SPILL_RUN_ROWS, memoryLimit / (threads * std::max<std::size_t>(1, rowBytes))));
+            spill = rows.size() * rowBytes > memoryLimit;
+        }
+
+        auto runs = Runs();
+        auto const count = (rows.size() + runRows - 1) / runRows;
+        runs.runs.resize(count);
+        auto const prefix = fmt::format("simple_database_{:08x}", std::random_device()());
+        if (spill) {
+            for (auto i = std::size_t(0); i < count; ++i) {
+                runs.runs[i].path = (std::filesystem::path(directory) / fmt::format("{}_{}.run", prefix, i)).string();
+            }
+        }
+
+        for (auto wave = std::size_t(0); wave < count; wave += threads) {
+            auto const last = std::min(count, wave + threads);
+            auto errors = std::vector<std::exception_ptr>(last - wave);
+            auto workers = std::vector<std::thread>();
+            for (auto i = wave; i < last; ++i) {
+                workers.emplace_back([&, i]() -> void {
+                    try {
+                        sortRun(rows, i * runRows, std::min(rows.size(), (i + 1) * runRows), runs.runs[i], encode);
+                    } catch (...) {
+                        errors[i - wave] = std::current_exception();
+                    }
+                });
+            }
+            for (auto& worker : workers) {
+                worker.join();
+            }
+            for (auto const& error : errors) {
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+            }
+        }
+
+        if (count == 1) {
+            for (auto i = std::size_t(0); i < rows.size(); ++i) {
+                rows[i] = getRow(runs.runs[0].keys[i]);
+            }
+            return;
+        }
+
+        for (auto pass = 1; spill && runs.runs.size() > MERGE_WIDTH; ++pass) {
+            auto merged = Runs();
+            for (auto first = std::size_t(0); first < runs.runs.size(); first += MERGE_WIDTH) {
+                auto& run = merged.runs.emplace_back();
+                run.path = (std::filesystem::path(directory) / fmt::format("{}_{}_{}.run", prefix, pass, merged.runs.size())).string();
+                auto file = std::ofstream(run.path, std::ios::binary | std::ios::trunc);
+                if (!file) {
+                    throw std::runtime_error(fmt::format("Cannot write sort run '{}'.", run.path));
+                }
+                merge(runs.runs, first, std::min(runs.runs.size(), first + MERGE_WIDTH), [&file](std::string const& key) -> void {
+                    writeKey(file, key);
+                });
+                if (!file.flush()) {
+                    throw std::runtime_error(fmt::format("Cannot write sort run '{}'.", run.path));
+                }
+            }
+            // the runs of the previous pass are removed with merged
+            std::swap(runs.runs, merged.runs);
+        }
+
+        auto position = std::size_t(0);
+        merge(runs.runs, 0, runs.runs.size(), [&rows, &position](std::string const& key) -> void {
+            rows[position++] = getRow(key);
+        });
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Db::Sort {
+    // smaller inputs are sorted as one run, larger ones are split into one run per thread
+    constexpr auto MIN_RUN_ROWS = std::size_t(16384);
+    // runs cut to fit memoryLimit never get smaller, so a tiny limit cannot turn every few rows into a file
+    constexpr auto MIN_SPILL_RUN_ROWS = std::size_t(1024);
+
+    // keys compare bytewise (like memcmp) in the order of the encoded values, descending columns store inverted bytes
+    auto appendNumber(std::string& key, double value, bool descending) -> void;
+    auto appendText(std::string& key, std::string const& value, bool descending) -> void;
+
+    // encode appends the key of a row and is called from several threads at once, rowBytes estimates the memory of
+    // one key; when all keys do not fit in memoryLimit bytes (0 means no limit) sorted runs are spilled to files in
+    // directory and merged from there, the limit is approximate as runs keep at least MIN_SPILL_RUN_ROWS rows
+    auto sortRows(std::vector<int>& rows, std::function<void(std::string& key, int row)> const& encode,
+        std::size_t rowBytes, std::size_t memoryLimit, std::string const& directory) -> void;
+}
@@ -42,21 +42,62 @@
  *              ALTER_TABLE nazwa_tabeli DROP_COLUMN nazwa_kolumny
  *                  ALTER_TABLE tab2 DROP_COLUMN col7
  *
+ *          Tworzenie tabeli partycjonowanej:
+ *              CREATE_TABLE nazwa_tabeli kolumny... PARTITION_BY RANGE(nazwa_kolumny) granica1 [granica2 ...]
+ *              CREATE_TABLE nazwa_tabeli kolumny... PARTITION_BY HASH(nazwa_kolumny) liczba_partycji
+ *                  CREATE_TABLE tab4 col1 NUMBER col2 TEXT PARTITION_BY RANGE(col1) 100 200
+ *                  CREATE_TABLE tab5 col1 NUMBER col2 TEXT PARTITION_BY HASH(col2) 4
+ *
+ *                  UWAGA 1: partycje p0, p1, ... sa osobnymi tabelami, wiersz trafia do partycji wedlug wartosci
+ *                      kolumny klucza (n granic RANGE tworzy n + 1 partycji, pierwsza i ostatnia sa nieograniczone)
+ *
+ *                  UWAGA 2: SELECT pomija partycje, ktore nie moga zawierac wierszy spelniajacych warunki WHERE
+ *                      polaczone AND-ami, a pozostale partycje sa filtrowane rownolegle
+ *
+ *                  UWAGA 3: kolumny klucza nie mozna aktualizowac ani usunac
+ *
+ *          Dodawanie partycji:
+ *              ALTER_TABLE nazwa_tabeli ADD_PARTITION granica
+ *                  ALTER_TABLE tab4 ADD_PARTITION 300
+ *
+ *                  UWAGA 1: tylko dla RANGE, partycja zawierajaca granice jest dzielona, a jej wiersze przenoszone
+ *
+ *          Usuwanie partycji:
+ *              ALTER_TABLE nazwa_tabeli DROP_PARTITION nazwa_partycji
+ *                  ALTER_TABLE tab4 DROP_PARTITION p0
+ *
+ *                  UWAGA 1: tylko dla RANGE, usuwa wszystkie wiersze partycji bez przegladania pozostalych
+ *
+ *          Filtr Blooma kolumny:
+ *              ALTER_TABLE nazwa_tabeli ADD_BLOOM_FILTER nazwa_kolumny
+ *              ALTER_TABLE nazwa_tabeli DROP_BLOOM_FILTER nazwa_kolumny
+ *                  ALTER_TABLE tab2 ADD_BLOOM_FILTER col1
+ *
+ *                  UWAGA 1: dla kazdej porcji 2048 wierszy przechowywany jest filtr Blooma jej wartosci, warunek ==
+ *                      pomija porcje, ktorych filtr nie zawiera szukanej wartosci; filtry sa zapisywane razem z baza
+ *                      i wczytywane razem z kolumna
+ *
  *      DML:
  *          Dodawanie wiersza:
  *              ALTER_TABLE nazwa_tabeli INSERT_ROW wartosc1 wartosc2 wartosc3 wartosc4...
  *                  ALTER_TABLE tab2 INSERT_ROW aaa 111 bbb ccc 222
  *
  *          Aktualizowanie wiersza:
- *              ALTER_TABLE nazwa_tabeli UPDATE_ROW nazwa_kolumny nowa_wartosc [WHERE nazwa_kolumny_wartunkowej operator wartosc_warunkowa]
+ *              ALTER_TABLE nazwa_tabeli UPDATE_ROW nazwa_kolumny nowa_wartosc [WHERE warunki]
+ *              ALTER_TABLE nazwa_tabeli UPDATE_ROW SET nazwa_kolumny_1 nowa_wartosc_1[, nazwa_kolumny_2 nowa_wartosc_2 ...] [WHERE warunki]
  *                  ALTER_TABLE tab2 UPDATE_ROW col1 aaa
  *                  ALTER_TABLE tab2 UPDATE_ROW col2 123 WHERE col1 == aaa
+ *                  ALTER_TABLE tab2 UPDATE_ROW SET col1 bbb, col2 456 WHERE col2 > 100 AND col5 < 200
  *
  *                  UWAGA 1: dostepne operatory arytmetyczne: > >= == != <= <
  *
+ *                  UWAGA 2: warunki maja taka sama postac jak w klauzuli WHERE zapytania SELECT, wiersze sa wybierane
+ *                      raz, a potem zmieniane kolumna po kolumnie
+ *
  *          Usuwanie wiersza:
- *              ALTER_TABLE nazwa_tabeli DELETE_ROW WHERE nazwa_kolumny operator wartosc
+ *              ALTER_TABLE nazwa_tabeli DELETE_ROW WHERE warunki
  *                  ALTER_TABLE tab2 DELETE_ROW WHERE col1 == aaa
+ *                  ALTER_TABLE tab2 DELETE_ROW WHERE col1 == aaa OR col2 > 100
  *
  *      DQL:
  *          Wypisywanie danych:
@@ -68,6 +109,7 @@
  *                  SELECT col1 col2 col3 FROM tab2
  *
  *                  SELECT * FROM tab1 WHERE col1 == aaa
+ *                  SELECT * FROM tab1 WHERE col1 LIKE aa%
  *                  SELECT col1 col2 col3 FROM tab2 WHERE col2 > 100 AND col5 < 200
  *
  *                  SELECT * FROM tab1 ORDER_BY col2 ASC
@@ -80,31 +122,106 @@
  *                      jezeli mamy "col1 > 200 AND col2 < 3 OR col3 == 10 AND col4 != 100" to zostanie to przetlumaczone
  *                      jako "((((col1 > 200) AND col2 < 3) OR col3 == 10) AND col4 != 100)"
  *
- *                  UWAGA 2: dostepne operatory arytmetyczne: > >= == != <= <
+ *                  UWAGA 2: dostepne operatory arytmetyczne: > >= == != <= <, dla kolumn TEXT rowniez LIKE, gdzie
+ *                      % oznacza dowolny ciag znakow, a _ dokladnie jeden znak (np. col1 LIKE abc% lub col1 LIKE %abc%)
+ *
+ *                  UWAGA 3: warunki polaczone tym samym operatorem moga byc wykonane w innej kolejnosci (najpierw
+ *                      tanie i najbardziej selektywne wedlug statystyk z ANALYZE), a kolejne warunki sa pomijane gdy
+ *                      wynik AND / OR jest juz przesadzony
+ *
+ *          Zbieranie statystyk tabeli:
+ *              ANALYZE nazwa_tabeli
+ *                  ANALYZE tab2
+ *
+ *                  UWAGA 1: dla kazdej kolumny liczona jest liczba wartosci roznych, pustych oraz histogram,
+ *                      statystyki sa w przyblizeniu aktualizowane przy INSERT_ROW, UPDATE_ROW i DELETE_ROW
+ *
+ *          Tworzenie widoku zmaterializowanego:
+ *              CREATE_MATERIALIZED_VIEW nazwa_widoku AS SELECT ...
+ *                  CREATE_MATERIALIZED_VIEW view1 AS SELECT col1 col2 FROM tab2 WHERE col2 > 100
+ *
+ *                  UWAGA 1: widok jest tabela tylko do odczytu, odswiezana przy SELECT gdy tabela zrodlowa sie zmienila;
+ *                      jezeli od ostatniego odswiezenia byly tylko INSERT_ROW (i widok nie ma ORDER_BY), dopisywane sa
+ *                      tylko nowe wiersze
+ *
+ *                  UWAGA 2: po zapisie i odczycie bazy widok staje sie zwykla tabela
  *
  *      Inne:
  *          Zapisywanie bazy danych:
- *              WRITE_DATABASE sciezka_do_pliku_txt
+ *              WRITE_DATABASE sciezka_do_pliku_txt [BACKGROUND]
  *                  WRITE_DATABASE db.txt
  *                  WRITE_DATABASE /dir1/dir2/db.txt
+ *                  WRITE_DATABASE db.txt BACKGROUND
+ *
+ *                  UWAGA 1: plik jest zapisywany do pliku.tmp, synchronizowany z dyskiem i dopiero wtedy podmieniany,
+ *                      wiec przerwany zapis nie niszczy poprzedniej wersji
+ *
+ *                  UWAGA 2: BACKGROUND zapisuje migawke bazy w osobnym watku, zapytania i modyfikacje dzialaja dalej
+ *                      (kolumny sa kopiowane dopiero przy pierwszej modyfikacji - copy-on-write)
+ *
+ *          Zapisywanie bazy danych do katalogu (zapis przyrostowy):
+ *              WRITE_DATABASE sciezka_do_katalogu/
+ *                  WRITE_DATABASE db/
+ *
+ *                  UWAGA 1: kazda kolumna jest osobnym plikiem segmentu (*.seg), jej filtr Blooma osobnym plikiem
+ *                      (*.bloom), a plik MANIFEST opisuje tabele i kolumny
+ *
+ *                  UWAGA 2: przy kolejnym zapisie do tego samego katalogu zapisywane sa tylko kolumny zmienione od
+ *                      ostatniego zapisu, a MANIFEST jest podmieniany atomowo
+ *
+ *                  UWAGA 3: READ_DATABASE i OPEN_DATABASE przyjmuja rowniez sciezke do katalogu
+ *
+ *          Stan zapisu w tle:
+ *              SNAPSHOT_STATUS
  *
  *          Odczytywanie bazy danych:
  *              READ_DATABASE sciezka_do_pliku_txt
  *                  READ_DATABASE db.txt
  *                  READ_DATABASE /dir1/dir2/db.txt
  *
+ *          Otwieranie bazy danych bez wczytywania danych do pamieci:
+ *              OPEN_DATABASE sciezka_do_pliku_txt [rozmiar_bufora_w_bajtach]
+ *                  OPEN_DATABASE db.txt
+ *                  OPEN_DATABASE db.txt 1073741824
+ *
+ *                  UWAGA 1: wczytywany jest tylko katalog (nazwy, typy i polozenie kolumn w pliku), kolumny sa
+ *                      doczytywane przy pierwszym uzyciu do puli buforow (domyslnie 256 MiB) z wymiataniem LRU
+ *
+ *                  UWAGA 2: katalog jest zapisywany obok pliku jako plik.catalog i odtwarzany, gdy zmieni sie rozmiar
+ *                      lub czas modyfikacji pliku; zmienione kolumny wymiatane z puli sa zapisywane do katalogu plik.pages
+ *
  *          Wypisywanie nazwy tabel:
  *              TABLES_NAMES
  *
  *          Wypisywanie nazwy kolumn:
  *              COLUMNS_NAMES nazwa_tabeli
  *
+ *          Wypisywanie partycji tabeli:
+ *              PARTITIONS_NAMES nazwa_tabeli
+ *
  *          Wypisywanie liczby tabel:
  *              TABLES_COUNT
  *
  *          Wypisywanie liczby kolumn:
  *              COLUMNS_COUNT nazwa_tabeli
  *
+ *          Pamiec podreczna wynikow zapytan:
+ *              SET result_cache ON | OFF
+ *
+ *                  UWAGA 1: wynik SELECT jest zapamietywany dla tekstu zapytania i uniewazniany, gdy zmieni sie
+ *                      wersja tabeli (kazda modyfikacja danych lub schematu tabeli podbija jej wersje)
+ *
+ *          Limit pamieci sortowania:
+ *              SET memory_limit liczba_bajtow
+ *                  SET memory_limit 67108864
+ *
+ *                  UWAGA 1: ORDER_BY sortuje klucze binarne zbudowane z wartosci kolumn, w porcjach sortowanych
+ *                      rownolegle; gdy klucze wszystkich wierszy nie mieszcza sie w limicie, posortowane porcje sa
+ *                      zapisywane do plikow tymczasowych i scalane z dysku (0 oznacza brak limitu, domyslnie)
+ *
+ *                  UWAGA 2: limit jest przyblizony, porcja ma zawsze co najmniej 1024 wiersze, wiec bardzo maly limit
+ *                      jest przekraczany zamiast tworzenia pliku dla kazdego wiersza
+ *
  *          Zmiana nazwy bazy danych:
  *              RENAME_DATABASE nowa_nazwa
  *                  RENAME_DATABASE db2
@@ -0,0 +1,77 @@
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "db/db.hpp"
+
+// OPEN_DATABASE reads column offsets from the cached catalog, it has to return what READ_DATABASE returns even when
+// the catalog no longer belongs to the data file or was cut off
+namespace {
+    auto contents(std::string const& command) -> std::vector<std::vector<std::string>> {
+        auto database = Db::Database();
+        auto parser = Db::Parser{database};
+        parser.parseQuery(command);
+
+        auto result = std::vector<std::vector<std::string>>();
+        for (auto& table : database.tables) {
+            database.fetch(table);
+            for (auto const& column : table.columns) {
+                auto& values = result.emplace_back();
+                values.push_back(table.name + "." + column.name);
+                values.insert(values.end(), column.data.begin(), column.data.end());
+            }
+        }
+        return result;
+    }
+
+    auto write(std::string const& filename, std::vector<std::string> const& queries) -> void {
+        auto database = Db::Database();
+        auto parser = Db::Parser{database};
+        for (auto const& query : queries) {
+            parser.parseQuery(query);
+        }
+        parser.parseQuery(fmt::format("WRITE_DATABASE {}", filename));
+    }
+
+    auto check(std::string const& name, std::string const& filename) -> bool {
+        auto const opened = contents(fmt::format("OPEN_DATABASE {}", filename));
+        auto const read = contents(fmt::format("READ_DATABASE {}", filename));
+        if (opened != read) {
+            fmt::print(stderr, "{}: OPEN_DATABASE differs from READ_DATABASE\n", name);
+            return false;
+        }
+        return true;
+    }
+}
+
+auto main() -> int {
+    auto const directory = std::filesystem::temp_directory_path() / "simple_database_catalog";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    auto const filename = (directory / "db.txt").string();
+    auto const other = (directory / "other.txt").string();
+    auto passed = true;
+
+    // the data file is replaced by a different database that keeps an older modification time
+    write(filename, {"CREATE_TABLE t a TEXT", "ALTER_TABLE t INSERT_ROW x", "ALTER_TABLE t INSERT_ROW t"});
+    contents(fmt::format("OPEN_DATABASE {}", filename));
+    write(other, {"CREATE_TABLE zz b NUMBER", "ALTER_TABLE zz INSERT_ROW 1", "CREATE_TABLE t a TEXT",
+        "ALTER_TABLE t INSERT_ROW different"});
+    auto const time = std::filesystem::last_write_time(filename) - std::chrono::hours(1);
+    std::filesystem::copy_file(other, filename, std::filesystem::copy_options::overwrite_existing);
+    std::filesystem::last_write_time(filename, time);
+    passed = check("older data file", filename) && passed;
+
+    // the catalog is cut off after the data file was written
+    contents(fmt::format("OPEN_DATABASE {}", filename));
+    auto const catalog = filename + ".catalog";
+    std::filesystem::resize_file(catalog, std::filesystem::file_size(catalog) / 2);
+    passed = check("truncated catalog", filename) && passed;
+    std::filesystem::resize_file(catalog, 0);
+    passed = check("empty catalog", filename) && passed;
+
+    std::filesystem::remove_all(directory);
+    return passed ? 0 : 1;
+}